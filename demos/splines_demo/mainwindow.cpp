@@ -10,6 +10,7 @@ MainWindow::MainWindow(QWidget *parent)
    : QMainWindow(parent)
    , ui_(new Ui::MainWindow)
    , gl_widget_(new QGLWidgetEx())
+   , polyline_list_(0)
 {
    ui_->setupUi(this);
    gl_widget_->setParent(ui_->centralWidget);
@@ -20,6 +21,12 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+   if ( polyline_list_ )
+   {
+       gl_widget_->makeCurrent();
+       gl_widget_->DeleteDisplayList(polyline_list_);
+   }
+
    delete ui_;
 }
 
@@ -55,10 +62,20 @@ void MainWindow::OnDraw()
 
     gl_widget_->SetColor(1, 1, 1);
     gl_widget_->SetLineWidth(1.5);
-    std::vector<point2> approx;
-    spline_.approximate(ratio, back_inserter(approx));
-    if ( !approx.empty() )
-        gl_widget_->Polyline(&approx[0], approx.size());
+
+    // polyline is uploaded once per rebuild, mouse moves and small zooms just replay the display list
+    if ( tessellation_.update_polyline(spline_, ratio) || !polyline_list_ )
+    {
+        if ( polyline_list_ )
+            gl_widget_->DeleteDisplayList(polyline_list_);
+
+        const std::vector<point2> & approx = tessellation_.polyline();
+        polyline_list_ = gl_widget_->NewDisplayList();
+        if ( !approx.empty() )
+            gl_widget_->Polyline(&approx[0], approx.size());
+        gl_widget_->EndDisplayList();
+    }
+    gl_widget_->CallDisplayList(polyline_list_);
 
     if ( ui_->actionSegments->isChecked() )
     {
@@ -85,16 +102,12 @@ void MainWindow::OnDraw()
             gl_widget_->SetLineWidth(1);
             gl_widget_->SetColor(0, 1, 0);
 
-            const double step = ui_->arclengthStep->value();
-            const double len = spline_.length();
-            for ( double s = step; s < len; s += step )
-            {
-                const double t = spline_.s2t(s);
-                const point2 p = spline_(t);
-                const point2 n = spline_.normal(t);
+            tessellation_.update_markers(spline_, ui_->arclengthStep->value());
 
-                gl_widget_->Line(p - marker_r * ratio * n, p + marker_r * ratio * n);
-            }
+            const std::vector<point2> & ps = tessellation_.marker_points();
+            const std::vector<point2> & ns = tessellation_.marker_normals();
+            for ( size_t i = 0; i < ps.size(); i++ )
+                gl_widget_->Line(ps[i] - marker_r * ratio * ns[i], ps[i] + marker_r * ratio * ns[i]);
         }
 
         if ( ui_->actionClosest_Point->isChecked() )
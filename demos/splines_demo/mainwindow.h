@@ -6,11 +6,14 @@
 #define NOMINMAX 1
 
 #include "include/gui/glwidget/glwidget.h"
+#include "include/math/point2.h"
 #include "include/splines/spline.h"
 #include "include/splines/arclength.h"
 #include "include/splines/localization.h"
 #include "include/splines/builder.h"
 
+#include "tessellation_cache.h"
+
 struct scvt
 {
     static bool eq( const point2 & a, const point2 & b ) { return norm(a - b) < 1e-5; }
@@ -65,6 +68,9 @@ private:
    std::vector<point2> tangents_; // for hermite
    spline_type spline_;
 
+   tessellation_cache<spline_type> tessellation_;
+   int polyline_list_; // display list of tessellation_.polyline(), 0 if none
+
    size_t selected_point_;
    size_t selected_tangent_;
 };
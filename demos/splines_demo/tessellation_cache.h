@@ -0,0 +1,93 @@
+#ifndef TESSELLATION_CACHE_H
+#define TESSELLATION_CACHE_H
+
+#include <vector>
+#include <iterator>
+
+// tessellation_cache = spline polyline and arc-length markers kept between frames
+//    polyline is rebuilt when spline revision changes or view ratio leaves [ratio / hysteresis, ratio * hysteresis]
+//    of the last rebuild, it is built with accuracy ratio / hysteresis, so error never exceeds one pixel
+//    markers are rebuilt when spline revision or arc-length step changes
+//
+// Spline revisions are globally unique (only copies share them), so the cache follows any spline assigned to the watched one
+template < class Spline >
+class tessellation_cache
+{
+public:
+    typedef typename Spline::value_type value_type;
+    typedef typename Spline::parameter_type parameter_type;
+
+public:
+    explicit tessellation_cache( double hysteresis = 2 )
+        : hysteresis_(hysteresis)
+        , polyline_valid_(false)
+        , polyline_revision_(0)
+        , polyline_ratio_(0)
+        , markers_valid_(false)
+        , markers_revision_(0)
+        , markers_step_(0)
+    {
+    }
+
+    // returns true if polyline is rebuilt
+    bool update_polyline( const Spline & spline, double ratio )
+    {
+        if ( polyline_valid_ && polyline_revision_ == spline.revision()
+             && ratio >= polyline_ratio_ / hysteresis_ && ratio <= polyline_ratio_ * hysteresis_ )
+            return false;
+
+        polyline_.clear();
+        spline.approximate(ratio / hysteresis_, std::back_inserter(polyline_));
+
+        polyline_valid_ = true;
+        polyline_revision_ = spline.revision();
+        polyline_ratio_ = ratio;
+
+        return true;
+    }
+
+    // returns true if markers are rebuilt, the spline origin isn't marked
+    bool update_markers( const Spline & spline, parameter_type step )
+    {
+        if ( markers_valid_ && markers_revision_ == spline.revision() && markers_step_ == step )
+            return false;
+
+        std::vector<parameter_type> ts;
+        marker_points_.clear();
+        spline.resample_by_length(step, std::back_inserter(ts), std::back_inserter(marker_points_));
+
+        if ( !marker_points_.empty() )
+            marker_points_.erase(marker_points_.begin());
+
+        marker_normals_.clear();
+        for ( size_t i = 1; i < ts.size(); i++ )
+            marker_normals_.push_back(spline.normal(ts[i]));
+
+        markers_valid_ = true;
+        markers_revision_ = spline.revision();
+        markers_step_ = step;
+
+        return true;
+    }
+
+    const std::vector<value_type> & polyline() const { return polyline_; }
+
+    const std::vector<value_type> & marker_points() const { return marker_points_; }
+    const std::vector<value_type> & marker_normals() const { return marker_normals_; }
+
+private:
+    double hysteresis_;
+
+    std::vector<value_type> polyline_;
+    bool polyline_valid_;
+    size_t polyline_revision_;
+    double polyline_ratio_;
+
+    std::vector<value_type> marker_points_;
+    std::vector<value_type> marker_normals_;
+    bool markers_valid_;
+    size_t markers_revision_;
+    parameter_type markers_step_;
+};
+
+#endif // TESSELLATION_CACHE_H
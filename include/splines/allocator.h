@@ -0,0 +1,269 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Allocators support
+/// spline, its decorators and spline_builder use Allocator template parameter of spline for
+/// segments, control points and cached data (rebound to the stored type).
+///
+/// monotonic_arena + arena_allocator: memory is never freed by containers, the whole arena is
+/// released in one shot (e.g. after planning cycle), so short-lived splines don't call malloc.
+/// Cached data of decorators takes spline allocator when it's built, it requires allocators
+/// which propagate on container swap (arena_allocator does) or compare equal (std::allocator).
+
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <stdint.h>
+#include <memory>
+
+#include "splines_aux.h"
+
+namespace gsl
+{
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Allocator A rebound to type U
+        template < class A, class U >
+            struct rebind_alloc
+        {
+#if defined(GSL_CXX11)
+            typedef typename std::allocator_traits<A>::template rebind_alloc<U> type;
+#else
+            typedef typename A::template rebind<U>::other type;
+#endif
+        };
+
+        // ----------------------------------------------------------------
+        /// Alignment of type T
+        template < class T >
+            struct alignment_of
+        {
+            struct helper { char c; T t; };
+            static const size_type value = sizeof(helper) - sizeof(T);
+        };
+
+        // ----------------------------------------------------------------
+        /// Pointer 'p' rounded up to multiple of 'align' (power of 2)
+        inline char * align_up( char * p, size_type align )
+        {
+            const uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+            return p + (align - addr % align) % align;
+        }
+
+        // ----------------------------------------------------------------
+        /// Make container 'c' use allocator 'alloc' (converted to container allocator type), 'c' is cleared.
+        /// Container keeps its allocator if allocators don't propagate on swap
+        template < class C, class A >
+            void adopt_allocator( C & c, const A & alloc )
+        {
+            const typename C::allocator_type a(alloc);
+            if ( c.get_allocator() == a )
+            {
+                c.clear();
+                return;
+            }
+
+#if defined(GSL_CXX11)
+            if ( !std::allocator_traits<typename C::allocator_type>::propagate_on_container_swap::value )
+            {
+                c.clear();
+                return;
+            }
+#endif
+            C(a).swap(c);
+        }
+    }
+
+    // ----------------------------------------------------------------
+    /// monotonic_arena class
+    ///      Memory is allocated from blocks sequentially and released by release() or destructor only.
+    ///      Blocks grow geometrically, release() keeps the last (largest) block for reuse
+    class monotonic_arena
+    {
+    public:
+        /// Constructor. Block size is the size of the first block
+        explicit monotonic_arena( size_type block_size = 64 * 1024 );
+
+        /// Destructor frees all blocks
+        ~monotonic_arena();
+
+        /// Allocate 'bytes' aligned by 'align' (power of 2)
+        void * allocate( size_type bytes, size_type align );
+
+        /// Release all allocations at once
+        void release();
+
+        /// Number of bytes allocated since last release
+        size_type allocated() const { return m_Allocated; }
+
+        /// Number of bytes in blocks
+        size_type capacity() const { return m_Capacity; }
+
+    private:
+        monotonic_arena( const monotonic_arena & );
+        monotonic_arena & operator= ( const monotonic_arena & );
+
+        /// Block header, data follows it
+        struct block
+        {
+            block * prev;
+            size_type size;
+        };
+
+        static size_type header_size() { return (sizeof(block) + 15) / 16 * 16; }
+
+        void free_blocks( block * last );
+
+    private:
+        block * m_Last;
+        char * m_Ptr;
+        char * m_End;
+        size_type m_BlockSize;
+        size_type m_Allocated;
+        size_type m_Capacity;
+    };
+
+    // ----------------------------------------------------------------
+    /// arena_allocator class template
+    ///      Allocates from monotonic_arena, default constructed allocator uses operator new.
+    ///      Allocators are equal if they use the same arena
+    template < class T >
+        class arena_allocator
+    {
+    public:
+        //@{ Allocator types definition
+        typedef T value_type;
+        typedef T * pointer;
+        typedef const T * const_pointer;
+        typedef T & reference;
+        typedef const T & const_reference;
+        typedef gsl::size_type size_type;
+        typedef std::ptrdiff_t difference_type;
+        //@}
+
+#if defined(GSL_CXX11)
+        typedef std::true_type propagate_on_container_swap;
+#endif
+
+        template < class U > struct rebind
+        {
+            typedef arena_allocator<U> other;
+        };
+
+    public:
+        arena_allocator() : m_Arena(0) {}
+        explicit arena_allocator( monotonic_arena & arena ) : m_Arena(&arena) {}
+
+        template < class U >
+            arena_allocator( const arena_allocator<U> & rhs ) : m_Arena(rhs.arena()) {}
+
+        /// Used arena, 0 for operator new
+        monotonic_arena * arena() const { return m_Arena; }
+
+        pointer allocate( size_type n, const void * = 0 )
+        {
+            if ( !m_Arena )
+                return static_cast<pointer>(::operator new(n * sizeof(T)));
+
+            return static_cast<pointer>(m_Arena->allocate(n * sizeof(T), details::alignment_of<T>::value));
+        }
+
+        void deallocate( pointer p, size_type )
+        {
+            if ( !m_Arena )
+                ::operator delete(p);
+        }
+
+        void construct( pointer p, const T & val ) { new (p) T(val); }
+        void destroy( pointer p ) { p->~T(); }
+
+        pointer address( reference x ) const { return &x; }
+        const_pointer address( const_reference x ) const { return &x; }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+    private:
+        monotonic_arena * m_Arena;
+    };
+
+    template < class T, class U >
+        bool operator== ( const arena_allocator<T> & a, const arena_allocator<U> & b ) { return a.arena() == b.arena(); }
+
+    template < class T, class U >
+        bool operator!= ( const arena_allocator<T> & a, const arena_allocator<U> & b ) { return a.arena() != b.arena(); }
+
+    // ================================================================
+    // monotonic_arena class
+    // Implementation
+
+    // ----------------------------------------------------------------
+    inline monotonic_arena::monotonic_arena( size_type block_size )
+        : m_Last(0)
+        , m_Ptr(0)
+        , m_End(0)
+        , m_BlockSize(block_size)
+        , m_Allocated(0)
+        , m_Capacity(0)
+    {
+    }
+
+    // ----------------------------------------------------------------
+    inline monotonic_arena::~monotonic_arena()
+    {
+        this->free_blocks(0);
+    }
+
+    // ----------------------------------------------------------------
+    inline void * monotonic_arena::allocate( size_type bytes, size_type align )
+    {
+        char * p = m_Last ? details::align_up(m_Ptr, align) : 0;
+
+        if ( !m_Last || p + bytes > m_End )
+        {
+            const size_type size = std::max(bytes + align, m_Last ? 2 * m_Last->size : m_BlockSize);
+
+            block * b = static_cast<block *>(::operator new(header_size() + size));
+            b->prev = m_Last;
+            b->size = size;
+
+            m_Last = b;
+            m_Ptr = reinterpret_cast<char *>(b) + header_size();
+            m_End = m_Ptr + size;
+            m_Capacity += size;
+
+            p = details::align_up(m_Ptr, align);
+        }
+
+        m_Allocated += bytes;
+        m_Ptr = p + bytes;
+
+        return p;
+    }
+
+    // ----------------------------------------------------------------
+    inline void monotonic_arena::release()
+    {
+        if ( !m_Last )
+            return;
+
+        this->free_blocks(m_Last);
+
+        m_Last->prev = 0;
+        m_Ptr = reinterpret_cast<char *>(m_Last) + header_size();
+        m_Allocated = 0;
+        m_Capacity = m_Last->size;
+    }
+
+    // ----------------------------------------------------------------
+    /// Free all blocks except 'keep' (it should be the last block or 0)
+    inline void monotonic_arena::free_blocks( block * keep )
+    {
+        for ( block * b = m_Last; b; )
+        {
+            block * prev = b->prev;
+            if ( b != keep )
+                ::operator delete(b);
+            b = prev;
+        }
+    }
+}
@@ -1,184 +1,1127 @@
-///////////////////////////////////////////////////////////////////////////////
-/// arclength parametrization for segment and spline
-/// arclen(t0, t1) = integral[t0, t1]( |s'(t)| )dt
-/// t2s(t) = arclen(0, t)
-/// s2t(s) = t : (s - t2s(t)) == 0
-
-#pragma once
-
-#include "segment.h"
-#include "spline.h"
-
-namespace gsl
-{
-    // ----------------------------------------------------------------
-    /// segment arclength parametrization class template, compile-time decorator for segment
-    ///      This class supposed that U - point in Euclidian space, T - real type
-    ///      This class implements segment arc-length parametrization with required accuracy
-    template < class Base >
-        class segment_arclength
-            : public Base
-    {
-    public:
-        GSL_SEGMENT_DECORATOR(segment_arclength);
-
-    public:
-        /// Get arc-length of specified part of segment
-        parameter_type length( parameter_type from, parameter_type to, parameter_type accuracy ) const;
-        
-        /// Get full length of segment
-        parameter_type length( parameter_type accuracy ) const { return length(0, 1, accuracy); }
-
-        /// Convert parameter to natural parameter
-        parameter_type t2s( parameter_type t, parameter_type accuracy ) const;
-
-        /// Convert natural parameter to original [0, 1] parameter
-        parameter_type s2t( parameter_type s, parameter_type accuracy ) const;
-    };
-
-    // ----------------------------------------------------------------
-    /// spline parametrizator class template, compile-time decorator for spline
-    template < class Base, class S = segment_arclength<typename Base::segment_type> >
-        class spline_arclength
-            : public Base::template apply<S>::type
-    {
-    public:
-        GSL_SPLINE_DECORATOR(spline_arclength);
-
-    public:
-        /// Set required accuracy (of parameter 't')
-        void set_parametrization_accuracy( parameter_type accuracy ) { m_Accuracy = accuracy; }
-
-        /// Get full spline length
-        parameter_type length() const { return t2s(this->size()); }
-
-        /// Convert parameter to natural parameter
-        parameter_type t2s( parameter_type t ) const;
-
-        /// Convert natural parameter to original [0, 1] parameter
-        parameter_type s2t( parameter_type s ) const;
-
-    private:
-        parameter_type m_Accuracy;
-    };
-
-
-    // ================================================================
-    // segment_arclength class template
-    // Implementation
-
-#define TE template < class Base >
-#define ME segment_arclength<Base>::
-
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME length( parameter_type from, parameter_type to, parameter_type accuracy ) const
-    {
-        // TODO: clip [to, from] to [0, 1] ???
-
-        parameter_type c = (from + to) / 2;
-
-        value_type p0 = (*this)(from);
-        value_type p1 = (*this)(c);
-        value_type p2 = (*this)(to);
-
-        parameter_type l0 = details::norm_(p0 - p2);
-        parameter_type l1 = details::norm_(p0 - p1) + details::norm_(p1 - p2);
-
-        if ( l1 - l0 < accuracy ) // first estimate
-        {
-          value_type p01 = (*this)((from + c) / 2);
-          value_type p12 = (*this)((c + to) / 2);
-
-          parameter_type l2 = details::norm_(p0 - p01) + details::norm_(p01 - p1) + details::norm_(p1 - p12) + details::norm_(p12 - p2);
-
-          if ( l2 - l0 < accuracy ) // second estimate
-              return (16 * l2 - l1) / 15;
-        }
-        
-        // Single estimate
-        //if ( l1 - l0 < accuracy )
-        //    return (16 * l1 - l0) / 15;
-
-        return this->length(from, c, accuracy) + this->length(c, to, accuracy);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME t2s( parameter_type t, parameter_type accuracy ) const
-    {
-        return this->length(0, std::min(parameter_type(1), std::max(parameter_type(0), t)), accuracy);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME s2t( parameter_type s, parameter_type accuracy ) const
-    {
-        parameter_type step = 1, t = 1;
-        parameter_type l = this->length(accuracy);
-        
-        do
-        {
-            parameter_type d = this->t2s(t, accuracy) - s;
-
-            if ( fabs(d) < accuracy )
-                break;
-
-            if ( d < 0 )
-                t += step;
-            else
-                t -= step;
-
-            step /= 2;
-        }
-        while ( t <= 1 && 0 <= t && l * step > accuracy );
-
-        if ( fabs(this->t2s(t, accuracy) - s) > accuracy )
-            t = t; // binary search failed problem! (   -  )
-
-        return std::min(parameter_type(1), std::max(parameter_type(0), t));
-    }
-
-#undef TE
-#undef ME
-
-    // ================================================================
-    // spline_arclength class template
-    // Implementation
-
-#define TE template < class Base, class S >
-#define ME spline_arclength<Base, S>::
-
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME t2s( parameter_type t ) const
-    {
-        if ( this->empty() )
-            return 0;
-
-        size_type idx = this->parameter2idx(t);
-
-        parameter_type s = (*this)[idx].t2s(t, m_Accuracy);
-        for ( size_type i = 0; i < idx; i++ )
-          s += (*this)[i].length(m_Accuracy / this->size());
-          //s += (*this)[i].length(m_Accuracy); <-- error accumulation
-
-
-        return s;
-    }
-    
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME s2t( parameter_type s ) const
-    {
-        for ( size_t idx = 0; idx < this->size(); idx++ )
-        {
-            const parameter_type seg_length = (*this)[idx].length(m_Accuracy);
-            if ( s > seg_length )
-                s -= seg_length;
-            else
-                return idx + (*this)[idx].s2t(s, m_Accuracy);
-        }
-
-        return this->size() + 1;
-    }
-
-#undef TE
-#undef ME
-
-}
+///////////////////////////////////////////////////////////////////////////////
+/// arclength parametrization for segment and spline
+/// arclen(t0, t1) = integral[t0, t1]( |s'(t)| )dt
+/// t2s(t) = arclen(0, t)
+/// s2t(s) = t : (s - t2s(t)) == 0
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "segment.h"
+#include "spline.h"
+
+namespace gsl
+{
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Prefix sums of values of segments by blocks (see segment_blocks): sums[i] - sum of values of segments
+        /// from the block beginning to segment 'i' inclusive, bases[b] - sum of values of blocks before block 'b'
+        /// (the last one is the total sum). Replaced segments change sums of their blocks only
+        template < typename T, class C, class A >
+            struct block_sums
+        {
+            typedef C vector_type;
+            typedef std::vector<T, typename rebind_alloc<A, T>::type> bases_type;
+
+            explicit block_sums( const A & alloc = A() ) : blocks(alloc), sums(alloc), bases(alloc) {}
+
+            /// Sum of values of segments [0, i)
+            T offset( size_type i ) const { return i > 0 ? bases[blocks.find(i - 1)] + sums[i - 1] : T(0); }
+
+            /// Value of segment 'i'
+            T value( size_type i ) const { return i > blocks.begin(blocks.find(i)) ? sums[i] - sums[i - 1] : sums[i]; }
+
+            /// Sum of all values
+            T total() const { return bases.empty() ? T(0) : bases.back(); }
+
+            /// First segment which sum of values up to its end isn't less than 's', number of segments if there is no such
+            size_type find( T s ) const;
+
+            /// No segments, allocator is adopted from spline
+            template < class Al >
+                void reset( const Al & alloc );
+
+            /// Replace segments [from, to) with 'count' segments (zero values), blocks which contain them are split again.
+            /// Sums of segments [*begin, *end) (new segments and the rest of their blocks) are converted to values,
+            /// call accumulate for them after values of new segments are set
+            void replace( size_type from, size_type to, size_type count, size_type limit, size_type * begin, size_type * end );
+
+            //@{ Convert sums of segments [from, to) to values and back (bases are updated)
+            void difference( size_type from, size_type to );
+            void accumulate( size_type from, size_type to );
+            //@}
+
+            void swap( block_sums & rhs ) { blocks.swap(rhs.blocks); sums.swap(rhs.sums); bases.swap(rhs.bases); }
+
+            segment_blocks<A> blocks;
+            vector_type sums;
+            bases_type bases;
+        };
+
+        // ----------------------------------------------------------------
+        /// Arc-length table: lengths of segments by blocks, C - container of cached data of spline (see spline::cache)
+        template < typename T, class C, class A >
+            struct arclength_table
+        {
+            typedef C vector_type;
+
+            arclength_table() : error(0), revision(0), epoch(0), valid(false) {}
+
+            block_sums<T, C, A> lengths;
+            vector_type weights; ///< Weights of segments in error budget (see arclength_weight)
+            vector_type errors; ///< Error estimates of segments lengths
+            T error; ///< Sum of error estimates of segments lengths
+            size_type revision; ///< Spline revision the table was built for
+            size_type epoch; ///< Incremented when lengths of segments which weren't replaced are integrated again
+            bool valid;
+        };
+
+        // ----------------------------------------------------------------
+        /// Piecewise Chebyshev approximations of inverse arc-length maps t(s) of segments.
+        /// Segment i consists of pieces [pieces.offset(i), pieces.offset(i + 1)), piece k starts at arc-length
+        /// bounds[k] from the segment beginning, coefs[k * (degree + 1) + j] - its j-th coefficient.
+        /// C and I - containers of cached data of spline (see spline::cache) of T and size_type
+        template < typename T, class C, class I, class A >
+            struct inverse_arclength_table
+        {
+            typedef C vector_type;
+            typedef block_sums<size_type, I, A> pieces_type;
+
+            inverse_arclength_table() : degree(0), tolerance(0), max_depth(0), revision(0), epoch(0), valid(false) {}
+
+            size_type degree; ///< Zero degree means approximation is disabled
+            T tolerance;
+            size_type max_depth;
+            pieces_type pieces; ///< Numbers of pieces of segments
+            vector_type bounds;
+            vector_type coefs;
+            vector_type errors; ///< Maximum error in 't' for each segment, greater than tolerance if segment has no pieces
+            size_type revision;
+            size_type epoch; ///< Epoch of lengths table the approximations were fitted for
+            bool valid;
+        };
+
+        // ----------------------------------------------------------------
+        /// Evaluate Chebyshev series c[0]/2 + sum( c[j] * T_j(x) ) by Clenshaw recurrence, x in [-1, 1]
+        template < typename T, class RanIt >
+            T chebyshev_value( RanIt c, size_type n, T x )
+        {
+            T b1 = 0, b2 = 0;
+            for ( size_type j = n - 1; j > 0; j-- )
+            {
+                const T b0 = 2 * x * b1 - b2 + c[j];
+                b2 = b1;
+                b1 = b0;
+            }
+
+            return x * b1 - b2 + c[0] / 2;
+        }
+
+        // ----------------------------------------------------------------
+        /// Weight of segment in arc-length error budget: rough length (by 3 points) multiplied by
+        /// 1 + bend, bend is turning angle of the polyline (by law of cosines), so curved segments
+        /// which require more subdivisions get more tolerance
+        template < class Seg >
+            typename Seg::parameter_type arclength_weight( const Seg & seg )
+        {
+            typedef typename Seg::parameter_type T;
+            typedef typename Seg::value_type U;
+
+            const U p0 = seg(T(0)), p1 = seg(T(0.5)), p2 = seg(T(1));
+            const T a = norm_(p1 - p0), b = norm_(p2 - p1), c = norm_(p2 - p0);
+
+            if ( !(a > 0 && b > 0) )
+                return a + b;
+
+            const T cos_turn = std::min(T(1), std::max(T(-1), (c * c - a * a - b * b) / (2 * a * b)));
+            return (a + b) * (1 + acos(cos_turn));
+        }
+
+        // ----------------------------------------------------------------
+        /// Length of Bezier control polygon of segment part [from, to], it isn't less than arc-length.
+        /// Coefficients are shifted to 'from' (Taylor shift), c[j] = s^(j)(from) / j!, then they are scaled
+        /// to forward differences of control points h^j * c[j] / C(D, j), points are restored by summation of differences
+        template < class Seg, typename T >
+            T control_polygon_length( const Seg & seg, T from, T to )
+        {
+            typedef typename Seg::value_type U;
+            static const size_type D = Seg::Degree;
+
+            U c[D + 1];
+            std::copy(seg.coefficients(), seg.coefficients() + D + 1, c);
+
+            for ( size_type k = 0; k <= D; k++ )
+                for ( size_type i = D; i > k; i-- )
+                    c[i - 1] += from * c[i];
+
+            T scale = 1;
+            for ( size_type k = 1; k <= D; k++ )
+            {
+                scale *= (to - from) * T(k) / T(D - k + 1);
+                c[k] = scale * c[k];
+            }
+
+            T length = 0;
+            for ( size_type k = 1; k <= D; k++ )
+            {
+                length += norm_(c[1]);
+
+                for ( size_type j = 0; j + k <= D; j++ )
+                    c[j] += c[j + 1];
+            }
+
+            return length;
+        }
+
+        // ----------------------------------------------------------------
+        /// Approximate t(s) of segment with specified length on [s0, s1] (t0 = t(s0), t1 = t(s1))
+        /// by Chebyshev polynomial with n coefficients, piece is bisected while error bound (in 't') is
+        /// greater than tolerance and depth is positive. Append pieces to bounds and coefs,
+        /// return maximum error bound. 'scratch' keeps 2 * n values, it's reused by bisected pieces.
+        /// Coefficients are computed by interpolation at Chebyshev nodes in 's', node parameters
+        /// are found by iterative inversion. Error e(s) = p(s) - t(s) is checked at uniform parameters 't'
+        /// of piece where arc-length is integrated incrementally, between checks it's bounded by
+        /// h^2 / 8 * max|e''|: |p''| by Markov inequality for Chebyshev polynomials, |t''| <= |a| / |v|^3
+        /// with speed |v| bounded below by its samples and |a| by segment coefficients. Error estimates
+        /// of integrated arc-length are added multiplied by max|p'|. Number of checks is raised (up to 64 * n)
+        /// to keep the term between checks within a quarter of tolerance
+        template < class Seg, typename T, class V >
+            T fit_inverse_arclength( const Seg & seg, T length, T s0, T s1, T t0, T t1, size_type n,
+                                     T accuracy, T tolerance, size_type depth, V & bounds, V & coefs, T * scratch )
+        {
+            static const size_type D = Seg::Degree;
+
+            const T pi = acos(T(-1));
+            T * ts = scratch, * c = scratch + n;
+
+            for ( size_type k = 0; k < n; k++ )
+                ts[k] = seg.s2t(s0 + (cos(pi * (k + T(0.5)) / n) + 1) / 2 * (s1 - s0), length, accuracy);
+
+            for ( size_type j = 0; j < n; j++ )
+            {
+                T sum = 0;
+                for ( size_type k = 0; k < n; k++ )
+                    sum += ts[k] * cos(pi * j * (k + T(0.5)) / n);
+
+                c[j] = 2 * sum / n;
+            }
+
+            // |T_j'| <= j^2, |T_j''| <= j^2 (j^2 - 1) / 3 on [-1, 1], x = 2 * s / (s1 - s0) - 1
+            const T dx = 2 / (s1 - s0);
+            T p1 = 0, p2 = 0;
+            for ( size_type j = 1; j < n; j++ )
+            {
+                p1 += T(j * j) * fabs(c[j]);
+                p2 += T(j * j) * T(j * j - 1) / 3 * fabs(c[j]);
+            }
+            p1 *= dx;
+            p2 *= dx * dx;
+
+            // |s''(t)| <= sum of k (k - 1) |a_k| for t in [0, 1]
+            T a = 0;
+            for ( size_type k = 2; k <= D; k++ )
+                a += T(k * (k - 1)) * norm_(seg.coefficients()[k]);
+
+            size_type checks = 8 * n;
+            const T dt = (t1 - t0) / checks;
+
+            T vmin = std::numeric_limits<T>::max(), vmax = 0;
+            for ( size_type k = 0; k <= checks; k++ )
+            {
+                const T v = norm_(seg.template derivative<1>(t0 + dt * k));
+                vmin = std::min(vmin, v);
+                vmax = std::max(vmax, v);
+            }
+            vmin -= a * dt / 2;
+            vmax += a * dt / 2;
+
+            T error = std::numeric_limits<T>::max();
+
+            // speed isn't bounded away from zero: t(s) can't be bounded, piece is bisected
+            if ( vmin > 0 )
+            {
+                const T e2 = p2 + a / (vmin * vmin * vmin);
+                if ( e2 > 0 )
+                {
+                    const T steps = ceil((t1 - t0) * vmax / sqrt(2 * tolerance / e2));
+                    if ( steps > T(checks) )
+                        checks = steps < T(64 * n) ? size_type(steps) : 64 * n;
+                }
+
+                const T h = (t1 - t0) / checks * vmax;
+                T s = 0, integration = 0;
+                error = fabs(chebyshev_value(c, n, T(-1)) - t0);
+
+                // piece which will be bisected isn't checked further
+                for ( size_type k = 1; k <= checks && (error <= tolerance || depth == 0); k++ )
+                {
+                    const T ta = t0 + (t1 - t0) * (k - 1) / checks, tb = t0 + (t1 - t0) * k / checks;
+                    s += seg.length(ta, tb, accuracy / checks, &integration);
+                    error = std::max(error, fabs(chebyshev_value(c, n, dx * s - 1) - tb));
+                }
+
+                error += h * h / 8 * e2 + p1 * integration;
+            }
+
+            if ( error <= tolerance || depth == 0 )
+            {
+                bounds.push_back(s0);
+                coefs.insert(coefs.end(), c, c + n);
+                return error;
+            }
+
+            const T sm = (s0 + s1) / 2, tm = seg.s2t(sm, length, accuracy);
+
+            // pieces are appended in order
+            const T e0 = fit_inverse_arclength(seg, length, s0, sm, t0, tm, n, accuracy, tolerance, depth - 1, bounds, coefs, scratch);
+            const T e1 = fit_inverse_arclength(seg, length, sm, s1, tm, t1, n, accuracy, tolerance, depth - 1, bounds, coefs, scratch);
+
+            return std::max(e0, e1);
+        }
+    }
+
+    // ----------------------------------------------------------------
+    /// Arc-length integration policies for segment_arclength
+    ///     static T length( const Seg & seg, T from, T to, T accuracy, T * error )
+    ///     error estimate of the result is added to *error
+
+    // ----------------------------------------------------------------
+    /// Length of polyline inscribed in segment with Richardson extrapolation, segment is subdivided
+    /// recursively while estimates differ more than accuracy or control polygon of piece is too long
+    /// for them (samples missed a loop or a cusp).
+    /// Error estimate is the sum of differences of the last two polyline lengths of pieces, halves of
+    /// subdivided piece share its accuracy, so the estimate doesn't exceed accuracy (unless accuracy
+    /// is below rounding error of segment values)
+    struct chord_integration
+    {
+        template < class Seg, typename T >
+            static T length( const Seg & seg, T from, T to, T accuracy, T * error );
+
+    private:
+        /// Subdivide piece, estimates can't differ less than rounding error of segment values
+        template < class Seg, typename T >
+            static T length( const Seg & seg, T from, T to, T accuracy, T rounding, T * error );
+    };
+
+    // ----------------------------------------------------------------
+    /// Adaptive Gauss-Kronrod 7-15 quadrature of |s'(t)|. Interval is bisected while difference
+    /// of Gauss and Kronrod estimates (error estimate of Gauss rule) is greater than accuracy.
+    /// Integrand is smooth for polynomial segments, so one or two levels are usually enough
+    struct gauss_kronrod_integration
+    {
+        template < class Seg, typename T >
+            static T length( const Seg & seg, T from, T to, T accuracy, T * error );
+    };
+
+    // ----------------------------------------------------------------
+    /// segment arclength parametrization class template, compile-time decorator for segment
+    ///      This class supposed that U - point in Euclidian space, T - real type
+    ///      This class implements segment arc-length parametrization with required accuracy
+    ///      Integration - arc-length integration policy (chord_integration, gauss_kronrod_integration)
+    template < class Base, class Integration = chord_integration >
+        class segment_arclength
+            : public Base
+    {
+    public:
+        GSL_SEGMENT_DECORATOR(segment_arclength);
+
+    public:
+        /// Get arc-length of specified part of segment
+        parameter_type length( parameter_type from, parameter_type to, parameter_type accuracy ) const;
+
+        /// Get arc-length of specified part of segment, add error estimate to *error
+        parameter_type length( parameter_type from, parameter_type to, parameter_type accuracy, parameter_type * error ) const;
+
+        /// Get full length of segment
+        parameter_type length( parameter_type accuracy ) const { return length(0, 1, accuracy); }
+
+        /// Convert parameter to natural parameter
+        parameter_type t2s( parameter_type t, parameter_type accuracy ) const;
+
+        /// Convert natural parameter to original [0, 1] parameter
+        parameter_type s2t( parameter_type s, parameter_type accuracy ) const;
+
+        /// Convert natural parameter to original [0, 1] parameter, full segment length is known
+        parameter_type s2t( parameter_type s, parameter_type length, parameter_type accuracy ) const;
+
+        /// Get parameter of the point at arc-length distance ds from the point with parameter t
+        /// (backward if ds is negative), result is clipped to [0, 1]
+        parameter_type advance( parameter_type t, parameter_type ds, parameter_type accuracy ) const;
+
+    private:
+        parameter_type advance( parameter_type t, parameter_type ds, parameter_type guess, bool bounded, parameter_type accuracy ) const;
+    };
+
+    // ----------------------------------------------------------------
+    /// spline parametrizator class template, compile-time decorator for spline
+    template < class Base, class S = segment_arclength<typename Base::segment_type> >
+        class spline_arclength
+            : public Base::template apply<S>::type
+    {
+    public:
+        GSL_SPLINE_DECORATOR(spline_arclength);
+
+    public:
+        /// Set required accuracy (of parameter 't')
+        void set_parametrization_accuracy( parameter_type accuracy ) { m_Accuracy = accuracy; m_Table.valid = m_Inverse.valid = false; }
+
+        /// Get full spline length
+        parameter_type length() const;
+
+        /// Get error estimate of the full spline length (sum of estimates of segments lengths),
+        /// it doesn't exceed parametrization accuracy unless accuracy is below rounding errors
+        parameter_type length_error() const;
+
+        /// Convert parameter to natural parameter
+        parameter_type t2s( parameter_type t ) const;
+
+        /// Convert natural parameter to original [0, 1] parameter
+        parameter_type s2t( parameter_type s ) const;
+
+        /// Enable approximation of inverse arc-length map t(s) by Chebyshev polynomials of specified
+        /// degree, so s2t doesn't iterate. Approximation error (in 't') is bounded by its values at a dense
+        /// grid of integrated arc-length plus derivative bound between grid points (see fit_inverse_arclength),
+        /// pieces are bisected (up to 'max_depth' times) until the bound is less than 'tolerance', otherwise
+        /// segment uses iterative inversion. The bound relies on error estimates of arc-length integration.
+        /// Zero degree disables approximation
+        void set_inverse_approximation( size_type degree, parameter_type tolerance, size_type max_depth = 12 );
+
+        /// Maximum error bound (in 't') of inverse approximation over approximated segments
+        parameter_type inverse_approximation_error() const;
+
+        /// Number of segments which use iterative inversion
+        size_type inverse_approximation_failures() const;
+
+        /// Memory used by inverse approximation per segment (on average), in bytes
+        size_type inverse_approximation_memory() const;
+
+        /// Obtain parameters and values of points at arc-length 0, step, 2 * step, ... up to the spline length
+        /// in a single pass along the spline. Return number of points
+        template < class OutParamIt, class OutPtIt >
+            size_type resample_by_length( parameter_type step, OutParamIt out_t, OutPtIt out_pts ) const;
+
+        /// Build lengths and inverse approximation tables ahead (see spline::prepare)
+        void prepare() const { Base::template apply<S>::type::prepare(); this->inverse_table(); }
+
+    protected:
+        //@{ Cached tables use spline allocator and containers of cached data (see spline::cache)
+        typedef typename details::rebind_alloc<allocator_type, parameter_type>::type parameter_allocator;
+        typedef typename Base::template cache<parameter_type>::type parameter_cache;
+        typedef typename Base::template cache<size_type>::type index_cache;
+        typedef details::arclength_table<parameter_type, parameter_cache, parameter_allocator> lengths_table_type;
+        typedef details::inverse_arclength_table<parameter_type, parameter_cache, index_cache, parameter_allocator> inverse_table_type;
+        typedef details::block_sums<parameter_type, parameter_cache, parameter_allocator> lengths_type;
+        //@}
+
+        /// Segments of blocks of cached data
+        static const size_type cache_block = Base::template cache<parameter_type>::block;
+
+        /// Rebuild lengths table if segments or accuracy were changed
+        const lengths_type & lengths() const;
+
+        /// Rebuild inverse approximation table if segments, accuracy or degree were changed
+        const inverse_table_type & inverse_table() const;
+
+    private:
+        /// Obtain parameter of segment by inverse approximation table if it's built for the segment
+        bool approximated_s2t( size_type idx, parameter_type ds, parameter_type * t ) const;
+
+        /// Integrate length of segment 'i' with specified tolerance, store it to lengths table (as value) and its error estimate
+        void integrate_segment( size_type i, parameter_type tolerance ) const;
+
+    private:
+        parameter_type m_Accuracy;
+        mutable lengths_table_type m_Table;
+        mutable inverse_table_type m_Inverse;
+    };
+
+
+    // ================================================================
+    // block_sums struct template
+    // Implementation
+
+#define TE template < typename T, class C, class A >
+#define ME details::block_sums<T, C, A>::
+
+    // ----------------------------------------------------------------
+    TE size_type ME find( T s ) const
+    {
+        // first block which sum up to its end isn't less than 's', then segment in the block
+        const size_type b = size_type(std::lower_bound(bases.begin() + 1, bases.end(), s) - bases.begin()) - 1;
+        if ( b == blocks.size() )
+            return blocks.size() > 0 ? blocks.end(b - 1) : 0;
+
+        const size_type idx = size_type(std::lower_bound(sums.begin() + blocks.begin(b), sums.begin() + blocks.end(b), s - bases[b]) - sums.begin());
+        return std::min(idx, blocks.end(b) - 1);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class Al > void ME reset( const Al & alloc )
+    {
+        blocks.reset(alloc);
+        adopt_allocator(sums, alloc);
+        adopt_allocator(bases, alloc);
+        bases.push_back(0);
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME replace( size_type from, size_type to, size_type count, size_type limit, size_type * begin, size_type * end )
+    {
+        size_type first, last;
+        blocks.affected(from, to, count, limit, &first, &last);
+
+        // blocks after the first one get new beginnings if number of segments is changed
+        *begin = (count != to - from && limit > 0) ? blocks.begin(first) : from;
+        *end = blocks.begin(last);
+
+        this->difference(*begin, *end);
+        splice(sums, from, to, count);
+        *end = *end + count - (to - from);
+
+        if ( count != to - from )
+        {
+            blocks.split(first, last, *end - blocks.begin(first), limit);
+            bases.resize(blocks.size() + 1);
+        }
+    }
+
+    // ----------------------------------------------------------------
+    /// Values are read by const reference, so shared chunks of sums are copied only if they're modified
+    TE void ME difference( size_type from, size_type to )
+    {
+        const vector_type & values = sums;
+
+        for ( size_type i = to, b = blocks.size(); i > from; i-- )
+        {
+            while ( blocks.begin(b - 1) >= i )
+                b--;
+
+            if ( i - 1 > blocks.begin(b - 1) )
+                sums[i - 1] -= T(values[i - 2]);
+        }
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME accumulate( size_type from, size_type to )
+    {
+        const vector_type & values = sums;
+
+        if ( blocks.size() == 0 )
+            return;
+
+        const size_type first = blocks.find(from);
+        for ( size_type i = from, b = first; i < to; i++ )
+        {
+            while ( blocks.end(b) <= i )
+                b++;
+
+            if ( i > blocks.begin(b) )
+                sums[i] += T(values[i - 1]);
+        }
+
+        for ( size_type b = first; b < blocks.size(); b++ )
+            bases[b + 1] = bases[b] + values[blocks.end(b) - 1];
+    }
+
+#undef TE
+#undef ME
+
+    // ================================================================
+    // Integration policies
+    // Implementation
+
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Gauss-Kronrod 7-15 nodes and weights on [-1, 1], nodes are symmetric:
+        /// kronrod_nodes[0..7] are positive nodes and zero, odd ones are Gauss nodes
+        template < typename T >
+            struct gauss_kronrod_table
+        {
+            static const T kronrod_nodes[8];
+            static const T kronrod_weights[8];
+            static const T gauss_weights[4];
+        };
+
+        template < typename T > const T gauss_kronrod_table<T>::kronrod_nodes[8] =
+        {
+            T(0.991455371120812639206854697526329), T(0.949107912342758524526189684047851),
+            T(0.864864423359769072789712788640926), T(0.741531185599394439863864773280788),
+            T(0.586087235467691130294144845693013), T(0.405845151377397166906606412076961),
+            T(0.207784955007898467600689403773245), T(0.000000000000000000000000000000000)
+        };
+
+        template < typename T > const T gauss_kronrod_table<T>::kronrod_weights[8] =
+        {
+            T(0.022935322010529224963732008058970), T(0.063092092629978553290700663189204),
+            T(0.104790010322250183839876322541518), T(0.140653259715525918745189590510238),
+            T(0.169004726639267902826583426598550), T(0.190350578064785409913256402421014),
+            T(0.204432940075298892414161999234649), T(0.209482141084727828012999174891714)
+        };
+
+        template < typename T > const T gauss_kronrod_table<T>::gauss_weights[4] =
+        {
+            T(0.129484966168869693270611432679082), T(0.279705391489276667901467771423780),
+            T(0.381830050505118944950369775488975), T(0.417959183673469387755102040816327)
+        };
+
+        // ----------------------------------------------------------------
+        /// Integrate |s'(t)| over [from, to] by Gauss-Kronrod 7-15 rule, error estimate is |K15 - G7|
+        template < class Seg, typename T >
+            T gauss_kronrod_15( const Seg & seg, T from, T to, T * error )
+        {
+            typedef gauss_kronrod_table<T> table;
+
+            const T c = (from + to) / 2;
+            const T h = (to - from) / 2;
+
+            const T fc = details::norm_(seg.template derivative<1>(c));
+            T k = fc * table::kronrod_weights[7];
+            T g = fc * table::gauss_weights[3];
+
+            for ( size_type i = 0; i < 7; i++ )
+            {
+                const T x = h * table::kronrod_nodes[i];
+                const T f = details::norm_(seg.template derivative<1>(c - x)) + details::norm_(seg.template derivative<1>(c + x));
+
+                k += f * table::kronrod_weights[i];
+                if ( i & 1 )
+                    g += f * table::gauss_weights[i / 2];
+            }
+
+            *error = fabs((k - g) * h);
+            return k * h;
+        }
+    }
+
+    // ----------------------------------------------------------------
+    template < class Seg, typename T > T chord_integration::length( const Seg & seg, T from, T to, T accuracy, T * error )
+    {
+        // rounding error of polynomial value is bounded by sum of coefficients magnitudes
+        T scale = 0;
+        for ( size_type i = 0; i <= Seg::Degree; i++ )
+            scale += details::norm_(seg.coefficients()[i]);
+
+        return length(seg, from, to, accuracy, 100 * std::numeric_limits<T>::epsilon() * scale, error);
+    }
+
+    // ----------------------------------------------------------------
+    template < class Seg, typename T > T chord_integration::length( const Seg & seg, T from, T to, T accuracy, T rounding, T * error )
+    {
+        typedef typename Seg::value_type value_type;
+
+        T c = (from + to) / 2;
+
+        value_type p0 = seg(from);
+        value_type p1 = seg(c);
+        value_type p2 = seg(to);
+
+        T l0 = details::norm_(p0 - p2);
+        T l1 = details::norm_(p0 - p1) + details::norm_(p1 - p2);
+
+        // estimates can't differ less than rounding error of points differences
+        accuracy = std::max(accuracy, rounding);
+
+        if ( l1 - l0 < accuracy ) // first estimate
+        {
+          value_type p01 = seg((from + c) / 2);
+          value_type p12 = seg((c + to) / 2);
+
+          T l2 = details::norm_(p0 - p01) + details::norm_(p01 - p1) + details::norm_(p1 - p12) + details::norm_(p12 - p2);
+
+          // samples can miss a loop of piece, its control polygon can't
+          if ( l2 - l0 < accuracy && details::control_polygon_length(seg, from, to) - l2 <= 2 * (l2 - l0) + accuracy ) // second estimate
+          {
+              *error += l2 - l1;
+              return (16 * l2 - l1) / 15;
+          }
+        }
+        
+        // Single estimate
+        //if ( l1 - l0 < accuracy )
+        //    return (16 * l1 - l0) / 15;
+
+        // piece can't be subdivided, its points differ by rounding errors
+        if ( !(from < c && c < to) )
+        {
+            *error += l1 - l0;
+            return l1;
+        }
+
+        const T l = length(seg, from, c, accuracy / 2, rounding, error);
+        return l + length(seg, c, to, accuracy / 2, rounding, error);
+    }
+
+    // ----------------------------------------------------------------
+    template < class Seg, typename T > T gauss_kronrod_integration::length( const Seg & seg, T from, T to, T accuracy, T * error )
+    {
+        T e;
+        const T l = details::gauss_kronrod_15(seg, from, to, &e);
+
+        // error can't be less than rounding error of the sum
+        if ( e <= std::max(accuracy, 50 * std::numeric_limits<T>::epsilon() * l) )
+        {
+            *error += e;
+            return l;
+        }
+
+        const T c = (from + to) / 2;
+        const T l0 = length(seg, from, c, accuracy / 2, error);
+        return l0 + length(seg, c, to, accuracy / 2, error);
+    }
+
+    // ================================================================
+    // segment_arclength class template
+    // Implementation
+
+#define TE template < class Base, class Integration >
+#define ME segment_arclength<Base, Integration>::
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME length( parameter_type from, parameter_type to, parameter_type accuracy ) const
+    {
+        parameter_type error = 0;
+        return this->length(from, to, accuracy, &error);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME length( parameter_type from, parameter_type to, parameter_type accuracy, parameter_type * error ) const
+    {
+        // TODO: clip [to, from] to [0, 1] ???
+        return Integration::length(*this, from, to, accuracy, error);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME t2s( parameter_type t, parameter_type accuracy ) const
+    {
+        return this->length(0, std::min(parameter_type(1), std::max(parameter_type(0), t)), accuracy);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME s2t( parameter_type s, parameter_type accuracy ) const
+    {
+        return this->advance(0, s, 0, false, accuracy);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME s2t( parameter_type s, parameter_type length, parameter_type accuracy ) const
+    {
+        if ( s <= 0 )
+            return 0;
+
+        if ( s >= length )
+            return 1;
+
+        // initial guess is exact for the uniform speed
+        return this->advance(0, s, s / length, true, accuracy);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME advance( parameter_type t, parameter_type ds, parameter_type accuracy ) const
+    {
+        return this->advance(t, ds, t, false, accuracy);
+    }
+
+    // ----------------------------------------------------------------
+    /// Solve arclen(t, t + dir * u) == |ds| for u by Newton method, du = (|ds| - arclen) / |s'|.
+    /// Arc-length is integrated incrementally between iterates. Root is bracketed by [lo, hi],
+    /// step out of bracket (inflection points, zero speed) is replaced by bisection.
+    /// If root isn't known to be inside segment ('bounded'), the segment end is tried first
+    TE typename ME parameter_type ME advance( parameter_type t, parameter_type ds, parameter_type guess, bool bounded, parameter_type accuracy ) const
+    {
+        const size_type MaxIterations = 64;
+
+        t = std::min(parameter_type(1), std::max(parameter_type(0), t));
+
+        const parameter_type dir = ds < 0 ? parameter_type(-1) : parameter_type(1);
+        const parameter_type target = fabs(ds);
+
+        parameter_type lo = 0, hi = dir > 0 ? 1 - t : t;
+        parameter_type u = 0, s = 0;
+
+        if ( target <= accuracy )
+            return t;
+
+        for ( size_type i = 0; i < MaxIterations; i++ )
+        {
+            parameter_type next;
+
+            if ( i == 0 && guess != t )
+                next = std::min(hi, fabs(guess - t));
+            else
+                next = u + (target - s) / details::norm_(this->template derivative<1>(t + dir * u));
+
+            if ( !(lo < next && next < hi) ) // also rejects NaN
+                next = (!bounded && next >= hi) ? hi : (lo + hi) / 2;
+
+            if ( next == u )
+                break;
+
+            const parameter_type a = t + dir * std::min(u, next), b = t + dir * std::max(u, next);
+            const parameter_type l = this->length(std::min(a, b), std::max(a, b), accuracy / 4);
+
+            s += next > u ? l : -l;
+            u = next;
+
+            if ( !bounded && u == hi )
+            {
+                if ( s <= target ) // root is out of segment
+                    break;
+
+                bounded = true;
+            }
+
+            if ( fabs(s - target) <= accuracy )
+                break;
+
+            if ( s < target )
+                lo = u;
+            else
+                hi = u;
+        }
+
+        return std::min(parameter_type(1), std::max(parameter_type(0), t + dir * u));
+    }
+
+#undef TE
+#undef ME
+
+    // ================================================================
+    // spline_arclength class template
+    // Implementation
+
+#define TE template < class Base, class S >
+#define ME spline_arclength<Base, S>::
+
+    // ----------------------------------------------------------------
+    /// Error budget: segment tolerance is accuracy / n raised to its share of accuracy by weight, so long
+    /// and curved segments are integrated with larger tolerance. Sum of tolerances can exceed accuracy,
+    /// but error estimates are usually much less than tolerances. If the sum of estimates exceeds accuracy,
+    /// segments with estimates above accuracy / n are integrated again with tolerance accuracy / n.
+    /// If spline was changed by replace (see spline::changed_since), only replaced segments are integrated
+    /// (unless the sum of estimates exceeds accuracy), sums of lengths of their blocks are updated
+    TE const typename ME lengths_type & ME lengths() const
+    {
+        if ( m_Table.valid && m_Table.revision == this->revision() )
+            return m_Table.lengths;
+
+        const size_type n = this->size();
+        const parameter_type floor = m_Accuracy / std::max(n, size_type(1));
+
+        size_type head = 0, tail = 0;
+        if ( !m_Table.valid || !this->changed_since(m_Table.revision, &head, &tail) )
+        {
+            m_Table.lengths.reset(this->get_allocator());
+            details::adopt_allocator(m_Table.weights, this->get_allocator());
+            details::adopt_allocator(m_Table.errors, this->get_allocator());
+
+            m_Table.epoch++;
+            head = tail = 0;
+        }
+
+        // lengths of segments [from, to) are stored instead of sums, then they are accumulated again
+        const size_type old_n = m_Table.weights.size();
+        size_type from, to;
+        m_Table.lengths.replace(head, old_n - tail, n - tail - head, cache_block, &from, &to);
+        details::splice(m_Table.weights, head, old_n - tail, n - tail - head);
+        details::splice(m_Table.errors, head, old_n - tail, n - tail - head);
+
+        // tables are read by const references, so shared chunks are copied only if they're modified
+        const parameter_cache & weights = m_Table.weights;
+        const parameter_cache & errors = m_Table.errors;
+
+        for ( size_type i = head; i < n - tail; i++ )
+            m_Table.weights[i] = details::arclength_weight((*this)[i]);
+
+        parameter_type sum = 0;
+        for ( size_type i = 0; i < n; i++ )
+            sum += weights[i];
+
+        for ( size_type i = head; i < n - tail; i++ )
+            this->integrate_segment(i, sum > 0 ? std::max(floor, m_Accuracy * weights[i] / sum) : floor);
+
+        m_Table.error = 0;
+        for ( size_type i = 0; i < n; i++ )
+            m_Table.error += errors[i];
+
+        if ( m_Table.error > m_Accuracy )
+        {
+            m_Table.lengths.difference(0, from);
+            m_Table.lengths.difference(to, n);
+            from = 0;
+            to = n;
+
+            m_Table.error = 0;
+            for ( size_type i = 0; i < n; i++ )
+            {
+                if ( errors[i] > floor )
+                    this->integrate_segment(i, floor);
+
+                m_Table.error += errors[i];
+            }
+
+            m_Table.epoch++;
+        }
+
+        m_Table.lengths.accumulate(from, to);
+
+        m_Table.revision = this->revision();
+        m_Table.valid = true;
+
+        return m_Table.lengths;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME integrate_segment( size_type i, parameter_type tolerance ) const
+    {
+        parameter_type error = 0;
+        m_Table.lengths.sums[i] = (*this)[i].length(0, 1, tolerance, &error);
+        m_Table.errors[i] = error;
+    }
+
+    // ----------------------------------------------------------------
+    TE const typename ME inverse_table_type & ME inverse_table() const
+    {
+        const lengths_type & table = this->lengths();
+
+        if ( m_Inverse.degree == 0 || (m_Inverse.valid && m_Inverse.revision == this->revision()) )
+            return m_Inverse;
+
+        const size_type n = m_Inverse.degree + 1;
+        const size_type count = this->size();
+
+        // approximations of segments which weren't replaced are kept unless their lengths were integrated again
+        size_type head = 0, tail = 0;
+        if ( !m_Inverse.valid || m_Inverse.epoch != m_Table.epoch || !this->changed_since(m_Inverse.revision, &head, &tail) )
+        {
+            m_Inverse.pieces.reset(this->get_allocator());
+            details::adopt_allocator(m_Inverse.bounds, this->get_allocator());
+            details::adopt_allocator(m_Inverse.coefs, this->get_allocator());
+            details::adopt_allocator(m_Inverse.errors, this->get_allocator());
+
+            head = tail = 0;
+        }
+
+        // pieces [start, start + removed) of replaced segments are replaced with new ones
+        const size_type old_count = m_Inverse.errors.size();
+        const size_type start = m_Inverse.pieces.offset(head);
+        const size_type removed = m_Inverse.pieces.offset(old_count - tail) - start;
+
+        // numbers of pieces of segments [from, to) are stored instead of sums, then they are accumulated again
+        size_type from, to;
+        m_Inverse.pieces.replace(head, old_count - tail, count - tail - head, cache_block, &from, &to);
+        details::splice(m_Inverse.errors, head, old_count - tail, count - tail - head);
+
+        // pieces of replaced segments are appended to separate buffers, then they replace old pieces
+        std::vector<parameter_type, parameter_allocator> bounds(m_Inverse.bounds.get_allocator()), coefs(m_Inverse.coefs.get_allocator());
+        std::vector<parameter_type, parameter_allocator> scratch(2 * n, parameter_type(0), m_Inverse.coefs.get_allocator());
+
+        for ( size_type i = head; i < count - tail; i++ )
+        {
+            const size_type begin = bounds.size();
+            const parameter_type l = table.value(i);
+            parameter_type error = std::numeric_limits<parameter_type>::max();
+
+            if ( l > 0 )
+                error = details::fit_inverse_arclength((*this)[i], l, parameter_type(0), l, parameter_type(0), parameter_type(1), n,
+                                                       m_Accuracy, m_Inverse.tolerance, m_Inverse.max_depth, bounds, coefs, &scratch[0]);
+
+            // segment which can't be approximated uses iterative inversion
+            if ( !(error <= m_Inverse.tolerance) )
+            {
+                bounds.resize(begin);
+                coefs.resize(begin * n);
+            }
+
+            m_Inverse.errors[i] = error;
+            m_Inverse.pieces.sums[i] = bounds.size() - begin;
+        }
+
+        m_Inverse.bounds.erase(m_Inverse.bounds.begin() + start, m_Inverse.bounds.begin() + start + removed);
+        m_Inverse.bounds.insert(m_Inverse.bounds.begin() + start, bounds.begin(), bounds.end());
+        m_Inverse.coefs.erase(m_Inverse.coefs.begin() + start * n, m_Inverse.coefs.begin() + (start + removed) * n);
+        m_Inverse.coefs.insert(m_Inverse.coefs.begin() + start * n, coefs.begin(), coefs.end());
+
+        m_Inverse.pieces.accumulate(from, to);
+
+        m_Inverse.revision = this->revision();
+        m_Inverse.epoch = m_Table.epoch;
+        m_Inverse.valid = true;
+
+        return m_Inverse;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME set_inverse_approximation( size_type degree, parameter_type tolerance, size_type max_depth )
+    {
+        m_Inverse.degree = degree;
+        m_Inverse.tolerance = tolerance;
+        m_Inverse.max_depth = max_depth;
+        m_Inverse.valid = false;
+
+        if ( degree == 0 )
+        {
+            typename inverse_table_type::pieces_type(m_Inverse.bounds.get_allocator()).swap(m_Inverse.pieces);
+            typename inverse_table_type::vector_type(m_Inverse.bounds.get_allocator()).swap(m_Inverse.bounds);
+            typename inverse_table_type::vector_type(m_Inverse.coefs.get_allocator()).swap(m_Inverse.coefs);
+            typename inverse_table_type::vector_type(m_Inverse.errors.get_allocator()).swap(m_Inverse.errors);
+        }
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME inverse_approximation_error() const
+    {
+        const inverse_table_type & inv = this->inverse_table();
+
+        parameter_type error = 0;
+        for ( size_type i = 0; i < inv.errors.size(); i++ )
+            if ( inv.errors[i] <= inv.tolerance )
+                error = std::max(error, inv.errors[i]);
+
+        return error;
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME inverse_approximation_failures() const
+    {
+        const inverse_table_type & inv = this->inverse_table();
+
+        size_type count = 0;
+        for ( size_type i = 0; i < inv.errors.size(); i++ )
+            if ( !(inv.errors[i] <= inv.tolerance) )
+                count++;
+
+        return count;
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME inverse_approximation_memory() const
+    {
+        const inverse_table_type & inv = this->inverse_table();
+
+        if ( inv.degree == 0 || this->empty() )
+            return 0;
+
+        const size_type bytes = (inv.pieces.sums.size() + inv.pieces.blocks.starts.size()) * sizeof(size_type)
+            + (inv.bounds.size() + inv.coefs.size() + inv.errors.size() + inv.pieces.bases.size()) * sizeof(parameter_type);
+
+        return bytes / this->size();
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME length() const
+    {
+        return this->lengths().total();
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME length_error() const
+    {
+        this->lengths();
+        return m_Table.error;
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME t2s( parameter_type t ) const
+    {
+        if ( this->empty() )
+            return 0;
+
+        size_type idx = this->parameter2idx(t);
+
+        return this->lengths().offset(idx) + (*this)[idx].t2s(t, m_Accuracy);
+    }
+    
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME s2t( parameter_type s ) const
+    {
+        const lengths_type & table = this->lengths();
+
+        // first segment which ends at or after 's'
+        size_type idx = table.find(s);
+        if ( idx == this->size() )
+            return this->size() + 1;
+
+        const parameter_type ds = s - table.offset(idx);
+
+        parameter_type t;
+        if ( this->approximated_s2t(idx, ds, &t) )
+            return idx + t;
+
+        return idx + (*this)[idx].s2t(ds, table.value(idx), m_Accuracy);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class OutParamIt, class OutPtIt > size_type ME resample_by_length( parameter_type step, OutParamIt out_t, OutPtIt out_pts ) const
+    {
+        const lengths_type & table = this->lengths();
+
+        if ( !(step > 0) )
+            return 0;
+
+        size_type count = 0;
+        parameter_type s = 0, begin = 0;
+
+        for ( size_type idx = 0; idx < this->size() && s <= table.total(); idx++ )
+        {
+            const S & seg = (*this)[idx];
+            const parameter_type end = table.offset(idx + 1);
+            const parameter_type l = end - begin;
+
+            // samples of segment share its accuracy, so error doesn't accumulate along segment
+            const parameter_type accuracy = l > step ? m_Accuracy * step / l : m_Accuracy;
+
+            // parameter and arc-length from segment beginning of the previous sample
+            parameter_type t = 0, ds = 0;
+
+            for ( ; s <= end; s = ++count * step )
+            {
+                if ( !this->approximated_s2t(idx, s - begin, &t) )
+                    t = seg.advance(t, s - begin - ds, accuracy);
+
+                ds = s - begin;
+
+                *out_t++ = idx + t;
+                *out_pts++ = seg(t);
+            }
+
+            begin = end;
+        }
+
+        return count;
+    }
+
+    // ----------------------------------------------------------------
+    TE bool ME approximated_s2t( size_type idx, parameter_type ds, parameter_type * t ) const
+    {
+        const inverse_table_type & inv = this->inverse_table();
+
+        if ( inv.degree == 0 || !(inv.errors[idx] <= inv.tolerance) )
+            return false;
+
+        const size_type n = inv.degree + 1;
+
+        ds = std::max(parameter_type(0), ds);
+
+        // last piece which starts at or before 'ds'
+        const size_type first = inv.pieces.offset(idx), last = first + inv.pieces.value(idx);
+        const size_type p = size_type(std::upper_bound(inv.bounds.begin() + first + 1, inv.bounds.begin() + last, ds) - inv.bounds.begin()) - 1;
+
+        const parameter_type from = inv.bounds[p];
+        const parameter_type to = p + 1 < last ? inv.bounds[p + 1] : this->lengths().value(idx);
+
+        *t = details::chebyshev_value(inv.coefs.begin() + p * n, n, 2 * (ds - from) / (to - from) - 1);
+        *t = std::min(parameter_type(1), std::max(parameter_type(0), *t));
+
+        return true;
+    }
+
+#undef TE
+#undef ME
+
+}
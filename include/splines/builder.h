@@ -1,225 +1,488 @@
-///////////////////////////////////////////////////////////////////////////////
-/// Spline builder decorators
-/// All builder decorators supposed to be sealed classes
-///
-/// @todo implement modification of catmull_rom spline with specified flatness
-/// @todo implement modification of catmull_rom spline with different tangent calculation
-/// @todo implement natural cubic spline (spline which interpolate control points and provide continuously of the second derivative)
-/// @todo implement closed variant of builders
-/// @todo implement nurbs
-/// @todo local changes on insert, delete, change ???
-/// @todo move implementation to the end of file
-
-#pragma once
-
-#include "spline.h"
-
-namespace gsl
-{
-    /// Hermite-spline cubic segment
-    template < class S, class V > S hermite_segment( const V & p0, const V & p1, const V & t0, const V & t1 )
-    {
-        V coefs[] = { p0, t0, 3*p1 - 3*p0 - 2*t0 - t1, 2*p0 - 2*p1 + t0 + t1 };
-        return S(coefs, coefs + 4);
-    }
-
-    /// Bezier cubic segment
-    template < class S, class V > S bezier_segment( const V & p0, const V & p1, const V & p2, const V & p3 )
-    {
-        V coefs[] = { p0, 3*p1 - 3*p0, 3*p0 - 6*p1 + 3*p2, 3*p1 - p0 - 3*p2 + p3 };
-        return S(coefs, coefs + 4);
-    }
-
-    /// B-Spline cubic segment
-    template < class S, class V > S bspline_segment( const V & p0, const V & p1, const V & p2, const V & p3 )
-    {
-        V coefs[] = { p0/6 + (2/3.)*p1 + p2/6, p2/2 - p0/2, p0/2 + p2/2 - p1, p1/2 - p0/6 - p2/2 + p3/6 };
-        return S(coefs, coefs + 4);
-    }
-
-    /// Bezier N-order segment
-    template < class S, class InIt > S bezier_segment( InIt first, InIt last )
-    {
-      typedef typename S::parameter_type parameter_type;
-      typedef typename S::value_type value_type;
-
-      size_type N = std::distance(first, last) - 1;
-      std::vector<value_type> coefs(N + 1, value_type());
-
-      for ( size_type i = 0; i <= N; i++ )
-      {
-        parameter_type prod = 1;
-        for ( size_type j = 0; j < i; j++ )
-          prod *= N - j;
-
-        value_type sum = value_type();
-        for ( size_type k = 0; k <= i; k++ )
-            sum += (((k + i) & 1) ? -1 : 1) * (*(first + k)) / (details::fac<parameter_type>(k) * details::fac<parameter_type>(i - k));
-
-        coefs[i] = prod * sum;
-      }
-
-      return S(&coefs[0], &coefs[0] + N + 1);
-    }
-
-    // ----------------------------------------------------------------
-    /// Bezier cubic spline. To provide first derivative continuously 3 points (i-1, i, i+1) near segments connection should be collinear
-    template < class Base >
-        class bezier_spline
-    {
-    protected:
-        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
-        {
-            typedef typename Base::value_type value_type;
-            typedef typename Base::segment_type segment_type;
-
-            for ( size_type i = from; i + 3 < to; i += 3 )
-            {
-                value_type p0 = pts[i+0];
-                value_type p1 = pts[i+1];
-                value_type p2 = pts[i+2];
-                value_type p3 = pts[i+3];
-
-                *out++ = bezier_segment<segment_type>(p0, p1, p2, p3);
-            }
-        }
-    };
-
-    // ----------------------------------------------------------------
-    /// Bezier N-order spline
-    template < size_t N, class Base = void >
-        class bezier_n_spline
-    {
-    public:
-        // Convert to BuildPolicy interface
-        template < class T > struct apply : bezier_n_spline<N, T>
-        {
-            typedef bezier_n_spline<N, T> type;
-        };
-
-    protected:
-        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
-        {
-            typedef typename Base::segment_type segment_type;
-            for ( size_type i = from; i + N < to; i += N )
-                *out++ = bezier_segment<segment_type>(&pts[0] + i, &pts[0] + i + N + 1);
-        }
-    };
-
-    // ----------------------------------------------------------------
-    /// Catmull-Rom spline (Hermite spline with p'(i) = p(i+1) - p(i-1))
-    /// Provide continuously of the first derivative
-    template < class Base >
-        class catmull_rom_spline
-    {
-    protected:
-        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
-        {
-            typedef typename Base::value_type value_type;
-            typedef typename Base::segment_type segment_type;
-
-            for ( size_type i = from; i + 1 < to; i++ )
-            {
-                value_type p0 = (i > 0) ? pts[i - 1] : pts.front();
-                value_type p1 = pts[i];
-                value_type p2 = pts[i + 1];
-                value_type p3 = (i + 2 < pts.size()) ? pts[i + 2] : pts.back();
-
-                value_type t1 = (p2 - p0) / 2;
-                value_type t2 = (p3 - p1) / 2;
-
-                *out++ = hermite_segment<segment_type>(p1, p2, t1, t2);
-            }
-        }
-    };
-
-    // ----------------------------------------------------------------
-    /// B-Spline. Do not pass all control points. Provide continuously of the second derivative
-    template < class Base >
-        class b_spline
-    {
-    protected:
-        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
-        {
-            typedef typename Base::value_type value_type;
-            typedef typename Base::segment_type segment_type;
-
-            for ( size_type i = from; i + 1 < to; i++ )
-            {
-                value_type p0 = (i > 0) ? pts[i - 1] : (2*pts[0]-pts[1]);
-                value_type p1 = pts[i];
-                value_type p2 = pts[i + 1];
-                value_type p3 = (i + 2 < pts.size()) ? pts[i + 2] : (2*pts.back() - pts[pts.size()-2]);
-
-                *out++ = bspline_segment<segment_type>(p0, p1, p2, p3);
-            }
-        }
-    };
-
-    // ----------------------------------------------------------------
-    /// spline_builder class template
-    template < class Base, template <class> class BuildPolicy >
-        class spline_builder
-            : public Base
-            , public BuildPolicy<Base>
-    {
-    public:
-        //@{ Common types definition
-        typedef typename Base::segment_type segment_type;
-        typedef typename Base::parameter_type parameter_type;
-        typedef typename Base::value_type value_type;
-        //@}
-
-    public:
-        /// Default constructor
-        spline_builder() {}
-
-        /// Constructor by control points
-        template < class InIt >
-            spline_builder( InIt first, InIt last )
-                : m_ControlValues(first, last)
-        {
-            std::vector<segment_type> segs;
-            this->build(m_ControlValues, 0, m_ControlValues.size(), back_inserter(segs));
-            this->assign(segs.begin(), segs.end());
-        }
-
-        /// Control points direct access
-        const std::vector<value_type> & control_values() const { return m_ControlValues; }
-
-        /// @todo rebuild locally and use Base::replace in remove and insert methods
-        
-        /// Remove control point and rebuild spline
-        void remove( size_type where )
-        {
-            m_ControlValues.erase(m_ControlValues.begin() + where);
-
-            std::vector<segment_type> segs;
-            this->build(m_ControlValues, 0, m_ControlValues.size(), back_inserter(segs));
-            this->assign(segs.begin(), segs.end());
-        }
-
-        /// Insert new control point and rebuild spline
-        void insert( size_type where, value_type val )
-        {
-            m_ControlValues.insert(m_ControlValues.begin() + where, val);
-
-            std::vector<segment_type> segs;
-            this->build(m_ControlValues, 0, m_ControlValues.size(), back_inserter(segs));
-            this->assign(segs.begin(), segs.end());
-        }
-        
-        /// Change existing control point value
-        void change( size_type where, value_type val )
-        {
-            m_ControlValues.at(where) = val;
-
-            std::vector<segment_type> segs;
-            this->build(m_ControlValues, 0, m_ControlValues.size(), back_inserter(segs));
-            this->assign(segs.begin(), segs.end());
-        }
-
-    private:
-        std::vector<value_type> m_ControlValues;
-    };
-}
+///////////////////////////////////////////////////////////////////////////////
+/// Spline builder decorators
+/// All builder decorators supposed to be sealed classes
+///
+/// @todo implement modification of catmull_rom spline with specified flatness
+/// @todo implement modification of catmull_rom spline with different tangent calculation
+/// @todo implement closed variant of builders
+/// @todo implement nurbs
+/// @todo move implementation to the end of file
+
+#pragma once
+
+#include "spline.h"
+
+namespace gsl
+{
+    /// Hermite-spline cubic segment
+    template < class S, class V > S hermite_segment( const V & p0, const V & p1, const V & t0, const V & t1 )
+    {
+        V coefs[] = { p0, t0, 3*p1 - 3*p0 - 2*t0 - t1, 2*p0 - 2*p1 + t0 + t1 };
+        return S(coefs, coefs + 4);
+    }
+
+    /// Bezier cubic segment
+    template < class S, class V > S bezier_segment( const V & p0, const V & p1, const V & p2, const V & p3 )
+    {
+        V coefs[] = { p0, 3*p1 - 3*p0, 3*p0 - 6*p1 + 3*p2, 3*p1 - p0 - 3*p2 + p3 };
+        return S(coefs, coefs + 4);
+    }
+
+    /// B-Spline cubic segment
+    template < class S, class V > S bspline_segment( const V & p0, const V & p1, const V & p2, const V & p3 )
+    {
+        V coefs[] = { p0/6 + (2/3.)*p1 + p2/6, p2/2 - p0/2, p0/2 + p2/2 - p1, p1/2 - p0/6 - p2/2 + p3/6 };
+        return S(coefs, coefs + 4);
+    }
+
+    /// Cubic segment by ending points and second derivatives in them
+    template < class S, class V > S natural_segment( const V & p0, const V & p1, const V & m0, const V & m1 )
+    {
+        V coefs[] = { p0, p1 - p0 - (2*m0 + m1)/6, m0/2, (m1 - m0)/6 };
+        return S(coefs, coefs + 4);
+    }
+
+    /// Bezier N-order segment
+    template < class S, class InIt > S bezier_segment( InIt first, InIt last )
+    {
+      typedef typename S::parameter_type parameter_type;
+      typedef typename S::value_type value_type;
+
+      size_type N = std::distance(first, last) - 1;
+      std::vector<value_type> coefs(N + 1, value_type());
+
+      for ( size_type i = 0; i <= N; i++ )
+      {
+        parameter_type prod = 1;
+        for ( size_type j = 0; j < i; j++ )
+          prod *= N - j;
+
+        value_type sum = value_type();
+        for ( size_type k = 0; k <= i; k++ )
+            sum += (((k + i) & 1) ? -1 : 1) * (*(first + k)) / (details::fac<parameter_type>(k) * details::fac<parameter_type>(i - k));
+
+        coefs[i] = prod * sum;
+      }
+
+      return S(&coefs[0], &coefs[0] + N + 1);
+    }
+
+    namespace details
+    {
+        /// Support size of policies which segments depend on all control points
+        const size_type unbounded_support = size_type(-1) / 2;
+
+        /// Row of tridiagonal system after forward sweep: x[i] = d - c * x[i+1], z is used by cyclic system correction
+        template < typename T, typename U >
+            struct tridiagonal_row
+        {
+            T c;
+            T z;
+            U d;
+        };
+
+        // ----------------------------------------------------------------
+        /// Solve m[i-1] + 4 m[i] + m[i+1] = 6 (p[i+1] - 2 p[i] + p[i-1]) for second derivatives of
+        /// natural cubic spline on points p[0..n). Open spline: m[0] = m[n-1] = 0 (Thomas algorithm),
+        /// closed spline: indices are cyclic (Sherman-Morrison correction of Thomas algorithm).
+        /// Result is stored in rows[i].d, capacity of 'rows' is reused
+        template < typename T, typename U, class A, class Pts >
+            void natural_cubic_moments( const Pts & pts, size_type from, size_type n, bool closed, std::vector< tridiagonal_row<T, U>, A > & rows )
+        {
+            rows.resize(n);
+
+            if ( n < 3 )
+            {
+                for ( size_type i = 0; i < n; i++ )
+                    rows[i].d = U();
+                return;
+            }
+
+            if ( !closed )
+            {
+                rows[0].c = 0;
+                rows[0].d = U();
+
+                for ( size_type i = 1; i + 1 < n; i++ )
+                {
+                    const T w = 1 / (4 - rows[i - 1].c);
+                    rows[i].c = w;
+                    rows[i].d = w * (6 * (pts[from + i + 1] - 2 * pts[from + i] + pts[from + i - 1]) - rows[i - 1].d);
+                }
+
+                rows[n - 1].d = U();
+                for ( size_type i = n - 2; i > 0; i-- )
+                    rows[i].d = rows[i].d - rows[i].c * rows[i + 1].d;
+
+                return;
+            }
+
+            // cyclic matrix A = B + u * v^T, u = (gamma, 0, ..., 0, 1), v = (1, 0, ..., 0, 1 / gamma)
+            // solve B x = r and B z = u, then correct x
+            const T gamma = -4;
+
+            for ( size_type i = 0; i < n; i++ )
+            {
+                const U & prev = pts[from + (i > 0 ? i - 1 : n - 1)];
+                const U & next = pts[from + (i + 1 < n ? i + 1 : 0)];
+                const U r = 6 * (next - 2 * pts[from + i] + prev);
+
+                T b = 4;
+                if ( i == 0 )
+                    b -= gamma;
+                if ( i + 1 == n )
+                    b -= 1 / gamma;
+
+                const T u = (i == 0) ? gamma : ((i + 1 == n) ? T(1) : T(0));
+
+                if ( i == 0 )
+                {
+                    rows[i].c = 1 / b;
+                    rows[i].d = r / b;
+                    rows[i].z = u / b;
+                }
+                else
+                {
+                    const T w = 1 / (b - rows[i - 1].c);
+                    rows[i].c = w;
+                    rows[i].d = w * (r - rows[i - 1].d);
+                    rows[i].z = w * (u - rows[i - 1].z);
+                }
+            }
+
+            for ( size_type i = n - 1; i > 0; i-- )
+            {
+                rows[i - 1].d = rows[i - 1].d - rows[i - 1].c * rows[i].d;
+                rows[i - 1].z = rows[i - 1].z - rows[i - 1].c * rows[i].z;
+            }
+
+            const U num = rows[0].d + rows[n - 1].d / gamma;
+            const T den = 1 + rows[0].z + rows[n - 1].z / gamma;
+            for ( size_type i = 0; i < n; i++ )
+                rows[i].d = rows[i].d - (rows[i].z / den) * num;
+        }
+    }
+
+    // ----------------------------------------------------------------
+    /// Bezier cubic spline. To provide first derivative continuously 3 points (i-1, i, i+1) near segments connection should be collinear
+    template < class Base >
+        class bezier_spline
+    {
+    public:
+        //@{ Segment i is built on control points [i*segment_step - look_behind, i*segment_step + look_ahead]
+        static const size_type segment_step = 3;
+        static const size_type look_behind = 0;
+        static const size_type look_ahead = 3;
+        //@}
+
+    protected:
+        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
+        {
+            typedef typename Base::value_type value_type;
+            typedef typename Base::segment_type segment_type;
+
+            for ( size_type i = from; i + 3 < to; i += 3 )
+            {
+                value_type p0 = pts[i+0];
+                value_type p1 = pts[i+1];
+                value_type p2 = pts[i+2];
+                value_type p3 = pts[i+3];
+
+                *out++ = bezier_segment<segment_type>(p0, p1, p2, p3);
+            }
+        }
+    };
+
+    // ----------------------------------------------------------------
+    /// Bezier N-order spline
+    template < size_t N, class Base = void >
+        class bezier_n_spline
+    {
+    public:
+        // Convert to BuildPolicy interface
+        template < class T > struct apply : bezier_n_spline<N, T>
+        {
+            typedef bezier_n_spline<N, T> type;
+        };
+
+        //@{ Segment i is built on control points [i*segment_step - look_behind, i*segment_step + look_ahead]
+        static const size_type segment_step = N;
+        static const size_type look_behind = 0;
+        static const size_type look_ahead = N;
+        //@}
+
+    protected:
+        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
+        {
+            typedef typename Base::segment_type segment_type;
+            for ( size_type i = from; i + N < to; i += N )
+                *out++ = bezier_segment<segment_type>(pts.begin() + i, pts.begin() + i + N + 1);
+        }
+    };
+
+    // ----------------------------------------------------------------
+    /// Catmull-Rom spline (Hermite spline with p'(i) = p(i+1) - p(i-1))
+    /// Provide continuously of the first derivative
+    template < class Base >
+        class catmull_rom_spline
+    {
+    public:
+        //@{ Segment i is built on control points [i*segment_step - look_behind, i*segment_step + look_ahead]
+        static const size_type segment_step = 1;
+        static const size_type look_behind = 1;
+        static const size_type look_ahead = 2;
+        //@}
+
+    protected:
+        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
+        {
+            typedef typename Base::value_type value_type;
+            typedef typename Base::segment_type segment_type;
+
+            for ( size_type i = from; i + 1 < to; i++ )
+            {
+                value_type p0 = (i > 0) ? pts[i - 1] : pts.front();
+                value_type p1 = pts[i];
+                value_type p2 = pts[i + 1];
+                value_type p3 = (i + 2 < pts.size()) ? pts[i + 2] : pts.back();
+
+                value_type t1 = (p2 - p0) / 2;
+                value_type t2 = (p3 - p1) / 2;
+
+                *out++ = hermite_segment<segment_type>(p1, p2, t1, t2);
+            }
+        }
+    };
+
+    // ----------------------------------------------------------------
+    /// B-Spline. Do not pass all control points. Provide continuously of the second derivative
+    template < class Base >
+        class b_spline
+    {
+    public:
+        //@{ Segment i is built on control points [i*segment_step - look_behind, i*segment_step + look_ahead]
+        static const size_type segment_step = 1;
+        static const size_type look_behind = 1;
+        static const size_type look_ahead = 2;
+        //@}
+
+    protected:
+        template < class Pts, class OutIt > static void build( const Pts & pts, size_type from, size_type to, OutIt out )
+        {
+            typedef typename Base::value_type value_type;
+            typedef typename Base::segment_type segment_type;
+
+            for ( size_type i = from; i + 1 < to; i++ )
+            {
+                value_type p0 = (i > 0) ? pts[i - 1] : (2*pts[0]-pts[1]);
+                value_type p1 = pts[i];
+                value_type p2 = pts[i + 1];
+                value_type p3 = (i + 2 < pts.size()) ? pts[i + 2] : (2*pts.back() - pts[pts.size()-2]);
+
+                *out++ = bspline_segment<segment_type>(p0, p1, p2, p3);
+            }
+        }
+    };
+
+    // ----------------------------------------------------------------
+    /// Natural cubic spline. Interpolates control points and provide continuously of the second derivative,
+    /// second derivative is zero at the ends. Every segment depends on all control points
+    template < class Base >
+        class natural_cubic_spline
+    {
+    public:
+        //@{ Segment i is built on control points [i*segment_step - look_behind, i*segment_step + look_ahead]
+        static const size_type segment_step = 1;
+        static const size_type look_behind = details::unbounded_support;
+        static const size_type look_ahead = details::unbounded_support;
+        //@}
+
+    protected:
+        template < class Pts, class OutIt > void build( const Pts & pts, size_type from, size_type to, OutIt out )
+        {
+            typedef typename Base::segment_type segment_type;
+
+            if ( from + 1 >= to )
+                return;
+
+            // control points use builder allocator
+            details::adopt_allocator(m_Rows, pts.get_allocator());
+            details::natural_cubic_moments(pts, from, to - from, false, m_Rows);
+            const rows_type & rows = m_Rows;
+
+            for ( size_type i = 0; i + 1 < rows.size(); i++ )
+                *out++ = natural_segment<segment_type>(pts[from + i], pts[from + i + 1], rows[i].d, rows[i + 1].d);
+        }
+
+    private:
+        typedef details::tridiagonal_row<typename Base::parameter_type, typename Base::value_type> row_type;
+        typedef std::vector<row_type, typename details::rebind_alloc<typename Base::allocator_type, row_type>::type> rows_type;
+
+        rows_type m_Rows; ///< Rows of tridiagonal system, its capacity is reused by rebuilds
+    };
+
+    // ----------------------------------------------------------------
+    /// Closed natural cubic spline. Last segment connects last control point with the first one,
+    /// second derivative is continuous at the first control point too
+    template < class Base >
+        class closed_natural_cubic_spline
+    {
+    public:
+        //@{ Segment i is built on control points [i*segment_step - look_behind, i*segment_step + look_ahead]
+        static const size_type segment_step = 1;
+        static const size_type look_behind = details::unbounded_support;
+        static const size_type look_ahead = details::unbounded_support;
+        //@}
+
+    protected:
+        template < class Pts, class OutIt > void build( const Pts & pts, size_type from, size_type to, OutIt out )
+        {
+            typedef typename Base::segment_type segment_type;
+
+            if ( from + 1 >= to )
+                return;
+
+            // control points use builder allocator
+            details::adopt_allocator(m_Rows, pts.get_allocator());
+            details::natural_cubic_moments(pts, from, to - from, true, m_Rows);
+            const rows_type & rows = m_Rows;
+
+            const size_type n = rows.size();
+            for ( size_type i = 0; i < n; i++ )
+            {
+                const size_type j = (i + 1 < n) ? i + 1 : 0;
+                *out++ = natural_segment<segment_type>(pts[from + i], pts[from + j], rows[i].d, rows[j].d);
+            }
+        }
+
+    private:
+        typedef details::tridiagonal_row<typename Base::parameter_type, typename Base::value_type> row_type;
+        typedef std::vector<row_type, typename details::rebind_alloc<typename Base::allocator_type, row_type>::type> rows_type;
+
+        rows_type m_Rows; ///< Rows of tridiagonal system, its capacity is reused by rebuilds
+    };
+
+    // ----------------------------------------------------------------
+    /// spline_builder class template
+    template < class Base, template <class> class BuildPolicy >
+        class spline_builder
+            : public Base
+            , public BuildPolicy<Base>
+    {
+    public:
+        //@{ Common types definition
+        typedef typename Base::segment_type segment_type;
+        typedef typename Base::parameter_type parameter_type;
+        typedef typename Base::value_type value_type;
+        typedef typename Base::allocator_type allocator_type;
+
+        typedef typename Base::template container<value_type>::type control_values_type;
+        //@}
+
+    public:
+        /// Default constructor
+        spline_builder() {}
+
+        /// Constructor of empty spline with allocator (it's used for control points too)
+        explicit spline_builder( const allocator_type & alloc )
+            : Base(alloc)
+            , m_ControlValues(alloc)
+            , m_Buffer(alloc)
+        {
+        }
+
+        /// Constructor by control points
+        template < class InIt >
+            spline_builder( InIt first, InIt last, const allocator_type & alloc = allocator_type() )
+                : Base(alloc)
+                , m_ControlValues(first, last, alloc)
+                , m_Buffer(alloc)
+        {
+            this->rebuild_all();
+        }
+
+        GSL_DEFAULT_COPY_MOVE(spline_builder)
+
+        /// Control points direct access
+        const control_values_type & control_values() const { return m_ControlValues; }
+
+        /// Remove control point and rebuild affected segments
+        void remove( size_type where )
+        {
+            m_ControlValues.erase(m_ControlValues.begin() + where);
+            this->rebuild(where, 1, 0);
+        }
+
+        /// Insert new control point and rebuild affected segments
+        void insert( size_type where, value_type val )
+        {
+            m_ControlValues.insert(m_ControlValues.begin() + where, val);
+            this->rebuild(where, 0, 1);
+        }
+        
+        /// Change existing control point value and rebuild affected segments
+        void change( size_type where, value_type val )
+        {
+            m_ControlValues.at(where) = val;
+            this->rebuild(where, 1, 1);
+        }
+
+    private:
+        typedef BuildPolicy<Base> build_policy;
+
+        /// Number of segments built on 'n' control points
+        static size_type segments_count( size_type n )
+        {
+            return n > 0 ? (n - 1) / build_policy::segment_step : 0;
+        }
+
+        /// Rebuild segments after 'removed' control points starting with 'where' were replaced with 'inserted' ones
+        ///     Segments which don't touch changed points are kept. Segments after the change are kept
+        ///     only if points shift is multiple of segment step, otherwise the whole tail is rebuilt
+        void rebuild( size_type where, size_type removed, size_type inserted )
+        {
+            const size_type step = build_policy::segment_step;
+            const size_type behind = build_policy::look_behind;
+            const size_type ahead = build_policy::look_ahead;
+
+            const size_type new_count = segments_count(m_ControlValues.size());
+            const size_type old_count = segments_count(m_ControlValues.size() + removed - inserted);
+
+            if ( ahead == details::unbounded_support || behind == details::unbounded_support ||
+                 old_count != this->size() || old_count == 0 || new_count == 0 )
+            {
+                this->rebuild_all();
+                return;
+            }
+
+            // first segment which uses changed points
+            size_type from = where > ahead ? (where - ahead + step - 1) / step : 0;
+
+            // first segment (in new numbering) which uses only points after changed ones
+            size_type to_new = new_count, to_old = old_count;
+            if ( (inserted + step - removed % step) % step == 0 )
+            {
+                to_new = std::min(new_count, (where + inserted + behind + step - 1) / step);
+                to_old = to_new + old_count - new_count;
+            }
+
+            from = std::min(from, std::min(to_new, to_old));
+
+            m_Buffer.clear();
+            this->build(m_ControlValues, from * step, to_new * step + 1, std::back_inserter(m_Buffer));
+            this->replace(from, to_old, m_Buffer.begin(), m_Buffer.end());
+        }
+
+        /// Rebuild all segments, existing segments are overwritten in place
+        void rebuild_all()
+        {
+            m_Buffer.clear();
+            this->build(m_ControlValues, 0, m_ControlValues.size(), std::back_inserter(m_Buffer));
+            this->replace(0, this->size(), m_Buffer.begin(), m_Buffer.end());
+        }
+
+    private:
+        control_values_type m_ControlValues;
+        typename Base::template container<segment_type>::type m_Buffer; ///< Rebuilt segments buffer, its capacity is reused
+    };
+}
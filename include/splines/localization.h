@@ -1,166 +1,754 @@
-///////////////////////////////////////////////////////////////////////////////
-/// localization abilities for segment and spline
-///
-/// @todo implement get_aabb method
-/// @todo implement get_hull method for 2-dimensional value_type
-/// @todo implement has_intersection, intersect methods for 2-dimensional value_type
-/// @todo implement grid or aabb-tree based localization for 2-dimensional value_type
-
-#pragma once
-
-#include <functional>
-
-#include "segment.h"
-#include "spline.h"
-
-namespace gsl
-{
-    // ----------------------------------------------------------------
-    /// segment localization class template, compile-time decorator for segment
-    ///      This class supposed that U - point in Euclidean space, T - real type
-    ///      This class implements segment localization requests with required accuracy
-    template < class Base >
-        class segment_localization
-            : public Base
-    {
-    public:
-        GSL_SEGMENT_DECORATOR(segment_localization);
-
-    public:
-        /// Obtain distance from specified point to spline and parameter of the closest point on segment
-        parameter_type distance ( value_type p, parameter_type * t, parameter_type accuracy ) const;
-
-        void get_aabb( value_type * min, value_type * max ) const;
-
-        template < class OutIt > void get_hull( OutIt out ) const;
-
-        bool intersect( value_type s0, value_type s1, parameter_type * t ) const;
-    };
-
-    // ----------------------------------------------------------------
-    /// spline localization class template, compile-time decorator for spline
-    // ----------------------------------------------------------------
-    template < class Base, class S = segment_localization<typename Base::segment_type> >
-        class spline_localization
-            : public Base::template apply<S>::type
-    {
-    public:
-        GSL_SPLINE_DECORATOR(spline_localization);
-
-    public:
-        /// Set required accuracy (of parameter 't' obtained in distance) (current implementation not guarantee this in some special cases)
-        void set_localization_accuracy( parameter_type accuracy ) { m_Accuracy = accuracy; }
-
-        /// Same as segment_localization::distance, but for spline
-        parameter_type distance( value_type p, parameter_type * t = 0 ) const;
-
-        /// Same as segment_localization::intersect, but for spline
-        bool intersect( value_type s0, value_type s1, parameter_type * t ) const;
-
-    private:
-        parameter_type m_Accuracy;
-    };
-
-
-    // ================================================================
-    // segment_localization class template
-    // Implementation
-
-#define TE template < class Base >
-#define ME segment_localization<Base>::
-
-    namespace details
-    {
-    template < class segment_type >
-    struct point_to_segment_distance_t // <=> bind(details::distance_, p, bind(&Base::operator(), this, _1))
-    {
-        typedef typename segment_type::parameter_type parameter_type;
-        typedef typename segment_type::value_type value_type;
-
-        point_to_segment_distance_t( const value_type & p, const segment_type & s ) : p_(p), s_(s) {}
-
-        parameter_type operator() ( parameter_type t ) const
-        {
-            return details::norm_(p_ - s_(t));
-        }
-
-    private:
-        const value_type & p_;
-        const segment_type & s_;
-    };
-    }
-
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME distance ( value_type p, parameter_type * t, parameter_type accuracy ) const
-    {
-        /// @todo initial subdivision (   )
-        /// @todo distance -> distance_sqr
-
-        parameter_type tc = details::golden_section(parameter_type(0), parameter_type(1), accuracy,
-                                                    details::point_to_segment_distance_t<Base>(p, *this));
-
-        if ( t )
-            *t = tc;
-
-        return details::norm_(p - (*this)(tc));
-    }
-
-#undef TE
-#undef ME
-
-    // ================================================================
-    // spline_localization class template
-    // Implementation
-
-#define TE template < class Base, class S >
-#define ME spline_localization<Base, S>::
-
-    // ----------------------------------------------------------------
-    TE typename ME parameter_type ME distance ( value_type p, parameter_type * t ) const
-    {
-        parameter_type mt = 0, md = -1;
-        for ( size_type i = 0; i < this->size(); i++ )
-        {
-            parameter_type t;
-            parameter_type d = (*this)[i].distance(p, &t, m_Accuracy);
-            if ( d < md || md == -1 )
-            {
-                md = d;
-                mt = i + t;
-            }
-        }
-
-        if ( t )
-            *t = mt;
-
-        return md;
-    }
-
-    // ----------------------------------------------------------------
-    TE bool ME intersect( value_type s0, value_type s1, parameter_type * t ) const
-    {
-        parameter_type mt = 0, md = -1;
-        for ( size_type i = 0; i < this->size(); i++ )
-        {
-            parameter_type t;
-            if ( (*this)[i].intersect(s0, s1, &t) )
-            {
-                parameter_type d = details::norm_(s0 - (*this)[i](t));
-                if ( d < md || md == -1 )
-                {
-                    md = d;
-                    mt = i + t;
-                }
-            }
-        }
-
-        if ( t )
-            *t = mt;
-
-        return md != -1;
-    }
-
-#undef TE
-#undef ME
-
-}
+///////////////////////////////////////////////////////////////////////////////
+/// localization abilities for segment and spline
+///
+/// @todo implement get_hull method for 2-dimensional value_type
+/// @todo implement has_intersection, intersect methods for 2-dimensional value_type
+///
+/// If value_traits are specialized for value_type, spline_localization keeps aabb-tree over segments
+/// (updated on demand for replaced segments when spline is changed) and checks only segments which bounding box is closer
+/// than the closest found point. Otherwise all segments are checked. The tree consists of trees over blocks of segments
+/// kept in the container of cached data (see spline::cache) and a tree over blocks, so a change rebuilds its blocks only.
+
+#pragma once
+
+#include <functional>
+#include <algorithm>
+#include <vector>
+
+#include "segment.h"
+#include "spline.h"
+#include "value_traits.h"
+
+namespace gsl
+{
+    //@{ Closest point search modes
+    /// golden section search of distance minimum (default), requires only value_type operators, may find local minimum
+    struct localization_golden_section {};
+    /// all stationary points of squared distance are found as polynomial roots, requires value_traits
+    struct localization_exact {};
+    //@}
+
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Item of aabb-tree (segment or block of segments). Tree over items [from, to) is split at
+        /// c = from + (to - from) / 2, so nodes of more than one item are stored in items they're split at
+        template < typename U >
+            struct aabb_node
+        {
+            typedef U value_type;
+
+            U min, max; ///< Box of item
+            U node_min, node_max; ///< Box of node which is split at the item
+        };
+
+        // ----------------------------------------------------------------
+        /// aabb-tree of spline: tree over segments of every block (see segment_blocks) and tree over blocks,
+        /// box of block is box of its tree. C - container of cached data of spline (see spline::cache)
+        template < typename U, class C, class A >
+            struct aabb_tree
+        {
+            typedef C nodes_type;
+            typedef std::vector<aabb_node<U>, typename rebind_alloc<A, aabb_node<U> >::type> blocks_type;
+
+            aabb_tree() : revision(0), valid(false) {}
+
+            segment_blocks<A> blocks;
+            nodes_type nodes; ///< Items are segments
+            blocks_type top; ///< Items are blocks
+            size_type revision; ///< Spline revision the tree was built for
+            bool valid;
+        };
+
+        // ----------------------------------------------------------------
+        /// Node [from, to) of aabb-tree over blocks (top) or over segments
+        struct aabb_range
+        {
+            size_type from, to;
+            bool top;
+        };
+
+        // ----------------------------------------------------------------
+        /// Squared distance from point to box (0 if point is inside)
+        template < typename U >
+            typename value_traits<U>::scalar_type aabb_distance_sqr( const U & p, const U & min, const U & max )
+        {
+            typedef value_traits<U> traits;
+            typename traits::scalar_type r = 0;
+
+            for ( size_type i = 0; i < traits::dimension; i++ )
+            {
+                const typename traits::scalar_type x = traits::get(p, i);
+                const typename traits::scalar_type d = std::max(traits::get(min, i) - x, x - traits::get(max, i));
+                if ( d > 0 )
+                    r += d * d;
+            }
+
+            return r;
+        }
+
+        // ----------------------------------------------------------------
+        /// Extend box [min, max] with box [bmin, bmax]
+        template < typename U >
+            void aabb_merge( U & min, U & max, const U & bmin, const U & bmax )
+        {
+            typedef value_traits<U> traits;
+
+            for ( size_type i = 0; i < traits::dimension; i++ )
+            {
+                traits::set(min, i, std::min(traits::get(min, i), traits::get(bmin, i)));
+                traits::set(max, i, std::max(traits::get(max, i), traits::get(bmax, i)));
+            }
+        }
+
+        // ----------------------------------------------------------------
+        /// Box of node [from, to) of tree over items
+        template < class V, typename U >
+            void aabb_box( const V & items, size_type from, size_type to, const U ** min, const U ** max )
+        {
+            if ( to - from == 1 )
+            {
+                *min = &items[from].min;
+                *max = &items[from].max;
+            }
+            else
+            {
+                const size_type c = from + (to - from) / 2;
+                *min = &items[c].node_min;
+                *max = &items[c].node_max;
+            }
+        }
+
+        // ----------------------------------------------------------------
+        /// Build nodes of tree over items [from, to) from boxes of items. If 'update' range is
+        /// specified, only nodes which contain items [update_from, update_to) are built again
+        template < class V >
+            void aabb_build( V & items, size_type from, size_type to, size_type update_from = 0, size_type update_to = size_type(-1) )
+        {
+            typedef typename V::value_type node_type;
+
+            if ( to - from < 2 || to <= update_from || update_to <= from )
+                return;
+
+            const size_type c = from + (to - from) / 2;
+            aabb_build(items, from, c, update_from, update_to);
+            aabb_build(items, c, to, update_from, update_to);
+
+            // children are read by const reference, so shared chunks aren't copied
+            const V & nodes = items;
+            const typename node_type::value_type * lmin, * lmax, * rmin, * rmax;
+            aabb_box(nodes, from, c, &lmin, &lmax);
+            aabb_box(nodes, c, to, &rmin, &rmax);
+
+            typename node_type::value_type min = *lmin, max = *lmax;
+            aabb_merge(min, max, *rmin, *rmax);
+
+            node_type & node = items[c];
+            node.node_min = min;
+            node.node_max = max;
+        }
+    }
+
+    // ----------------------------------------------------------------
+    /// segment localization class template, compile-time decorator for segment
+    ///      This class supposed that U - point in Euclidean space, T - real type
+    ///      This class implements segment localization requests with required accuracy
+    template < class Base >
+        class segment_localization
+            : public Base
+    {
+    public:
+        GSL_SEGMENT_DECORATOR(segment_localization);
+
+    public:
+        /// Obtain distance from specified point to spline and parameter of the closest point on segment
+        parameter_type distance ( value_type p, parameter_type * t, parameter_type accuracy ) const;
+
+        /// Obtain distance to the global closest point on segment: roots of (s(t) - p) * s'(t) (polynomial
+        /// of degree 2*Degree - 1) and segment ends are checked. Requires value_traits specialization for value_type
+        parameter_type distance ( value_type p, parameter_type * t, localization_exact ) const;
+
+        /// Obtain tight axis-aligned bounding box (extremums of components are found in roots of derivative)
+        /// Requires value_traits specialization for value_type
+        void get_aabb( value_type * min, value_type * max ) const;
+
+        template < class OutIt > void get_hull( OutIt out ) const;
+
+        bool intersect( value_type s0, value_type s1, parameter_type * t ) const;
+    };
+
+    // ----------------------------------------------------------------
+    /// spline localization class template, compile-time decorator for spline
+    // ----------------------------------------------------------------
+    template < class Base, class S = segment_localization<typename Base::segment_type> >
+        class spline_localization
+            : public Base::template apply<S>::type
+    {
+    public:
+        GSL_SPLINE_DECORATOR(spline_localization);
+
+    public:
+        /// Set required accuracy (of parameter 't' obtained in distance) (current implementation not guarantee this in some special cases)
+        ///     It's used by localization_golden_section mode only, localization_exact mode finds roots with rounding accuracy
+        void set_localization_accuracy( parameter_type accuracy ) { m_Accuracy = accuracy; }
+
+        /// Same as segment_localization::distance, but for spline (localization_golden_section mode)
+        parameter_type distance( value_type p, parameter_type * t = 0 ) const;
+
+        /// Same as segment_localization::distance, but for spline with specified search mode
+        ///     (localization_golden_section or localization_exact)
+        template < class Mode >
+            parameter_type distance( value_type p, parameter_type * t, Mode mode ) const;
+
+        //@{ Obtain distances to points [first, last) and parameters of the closest points (localization_golden_section
+        ///     mode by default). Search for every point starts from the closest segment of the previous point,
+        ///     so ordered points (e.g. trace along the spline) are processed much faster
+        template < class InIt, class OutD, class OutT >
+            void distance( InIt first, InIt last, OutD out_d, OutT out_t ) const;
+        template < class InIt, class OutD, class OutT, class Mode >
+            void distance( InIt first, InIt last, OutD out_d, OutT out_t, Mode mode ) const;
+        //@}
+
+        //@{ Same as above, but points are processed in parallel by chunks of 'grain' points
+        ///     Pool should provide parallel_for(count, grain, fn) calling fn(from, to) (see thread_pool.h)
+        ///     Iterators should be random access
+        template < class Pool, class RanIt, class OutD, class OutT >
+            void distance( Pool & pool, RanIt first, RanIt last, OutD out_d, OutT out_t, size_type grain = 1024 ) const;
+        template < class Pool, class RanIt, class OutD, class OutT, class Mode >
+            void distance( Pool & pool, RanIt first, RanIt last, OutD out_d, OutT out_t, size_type grain, Mode mode ) const;
+        //@}
+
+        /// Same as segment_localization::intersect, but for spline
+        bool intersect( value_type s0, value_type s1, parameter_type * t ) const;
+
+        /// Obtain bounding box of the whole spline
+        void get_aabb( value_type * min, value_type * max ) const;
+
+        /// Build aabb-tree ahead (see spline::prepare)
+        void prepare() const;
+
+    protected:
+        //@{ Cached tree uses spline allocator and container of cached data (see spline::cache)
+        typedef typename details::rebind_alloc<allocator_type, details::aabb_node<value_type> >::type aabb_allocator;
+        typedef typename Base::template cache< details::aabb_node<value_type> >::type aabb_nodes_type;
+        typedef details::aabb_tree<value_type, aabb_nodes_type, aabb_allocator> aabb_tree_type;
+        //@}
+
+        /// Segments of blocks of cached data
+        static const size_type cache_block = Base::template cache< details::aabb_node<value_type> >::block;
+
+        /// Rebuild aabb-tree if segments were changed. If spline was changed by replace (see spline::changed_since),
+        /// boxes of replaced segments are obtained only: nodes of their blocks which contain them are updated if number
+        /// of segments is the same, otherwise trees of their blocks are built again from boxes of segments.
+        /// Tree over blocks is built again
+        const aabb_tree_type & aabb_tree() const;
+
+        //@{ Check all segments / check segments using aabb-tree
+        ///     Segment 'hint' is checked first and search goes from it, if its box is closer than 'radius' to the point
+        template < class Mode >
+            parameter_type closest( value_type p, parameter_type * t, Mode mode, size_type hint, parameter_type radius, details::bool_constant<false> ) const;
+        template < class Mode >
+            parameter_type closest( value_type p, parameter_type * t, Mode mode, size_type hint, parameter_type radius, details::bool_constant<true> ) const;
+        //@}
+
+        //@{ Distance to segment with specified search mode
+        parameter_type segment_distance( size_type i, value_type p, parameter_type * t, localization_golden_section ) const { return (*this)[i].distance(p, t, m_Accuracy); }
+        parameter_type segment_distance( size_type i, value_type p, parameter_type * t, localization_exact ) const { return (*this)[i].distance(p, t, localization_exact()); }
+        //@}
+
+    private:
+        void prepare( details::bool_constant<false> ) const {}
+        void prepare( details::bool_constant<true> ) const { this->aabb_tree(); }
+
+    private:
+        parameter_type m_Accuracy;
+        mutable aabb_tree_type m_Tree;
+    };
+
+
+    // ================================================================
+    // segment_localization class template
+    // Implementation
+
+#define TE template < class Base >
+#define ME segment_localization<Base>::
+
+    namespace details
+    {
+    template < class segment_type >
+    struct point_to_segment_distance_t // <=> bind(details::distance_, p, bind(&Base::operator(), this, _1))
+    {
+        typedef typename segment_type::parameter_type parameter_type;
+        typedef typename segment_type::value_type value_type;
+
+        point_to_segment_distance_t( const value_type & p, const segment_type & s ) : p_(p), s_(s) {}
+
+        parameter_type operator() ( parameter_type t ) const
+        {
+            return details::norm_(p_ - s_(t));
+        }
+
+    private:
+        const value_type & p_;
+        const segment_type & s_;
+    };
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME distance ( value_type p, parameter_type * t, parameter_type accuracy ) const
+    {
+        /// @todo initial subdivision (проблема с точками перегиба)
+        /// @todo distance -> distance_sqr
+
+        parameter_type tc = details::golden_section(parameter_type(0), parameter_type(1), accuracy,
+                                                    details::point_to_segment_distance_t<Base>(p, *this));
+
+        if ( t )
+            *t = tc;
+
+        return details::norm_(p - (*this)(tc));
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME get_aabb( value_type * min, value_type * max ) const
+    {
+        typedef value_traits<value_type> traits;
+        typedef typename traits::scalar_type scalar_type;
+
+        const size_type N = Base::Degree + 1;
+        const value_type * coefs = this->coefficients();
+
+        *min = *max = coefs[0];
+
+        const value_type e = (*this)(1);
+        details::aabb_merge(*min, *max, e, e);
+
+        for ( size_type i = 0; i < traits::dimension; i++ )
+        {
+            scalar_type c[N], dc[N], roots[N];
+            for ( size_type k = 0; k < N; k++ )
+                c[k] = traits::get(coefs[k], i);
+
+            for ( size_type k = 1; k < N; k++ )
+                dc[k - 1] = k * c[k];
+
+            const size_type n = details::polynomial_roots<scalar_type, N - 1>::apply(dc, roots);
+            for ( size_type k = 0; k < n; k++ )
+            {
+                const scalar_type x = details::horner(c, N, roots[k]);
+                traits::set(*min, i, std::min(traits::get(*min, i), x));
+                traits::set(*max, i, std::max(traits::get(*max, i), x));
+            }
+        }
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME distance ( value_type p, parameter_type * t, localization_exact ) const
+    {
+        typedef value_traits<value_type> traits;
+        typedef typename traits::scalar_type scalar_type;
+
+        const size_type N = Base::Degree + 1;
+        const value_type * coefs = this->coefficients();
+
+        // f(t) = (s(t) - p) * s'(t), components of s(t) - p are stored to evaluate squared distance
+        scalar_type c[traits::dimension][N];
+        scalar_type f[2 * N - 2], roots[2 * N - 2];
+        std::fill(f, f + 2 * N - 2, scalar_type(0));
+
+        for ( size_type d = 0; d < traits::dimension; d++ )
+        {
+            for ( size_type k = 0; k < N; k++ )
+                c[d][k] = traits::get(coefs[k], d);
+            c[d][0] -= traits::get(p, d);
+
+            for ( size_type i = 0; i < N; i++ )
+                for ( size_type k = 1; k < N; k++ )
+                    f[i + k - 1] += c[d][i] * k * c[d][k];
+        }
+
+        // only roots where f changes sign from - to + are minimums of squared distance,
+        // f is monotonic between roots of f'
+        scalar_type df[2 * N - 3], ends[2 * N - 1];
+        for ( size_type i = 1; i < 2 * N - 2; i++ )
+            df[i - 1] = i * f[i];
+
+        const size_type m = details::polynomial_roots<scalar_type, 2 * N - 3>::apply(df, ends + 1);
+        ends[0] = 0;
+        ends[m + 1] = 1;
+
+        size_type n = 0;
+        scalar_type fa = f[0];
+        for ( size_type i = 1; i <= m + 1; i++ )
+        {
+            const scalar_type fb = details::horner(f, 2 * N - 2, ends[i]);
+            if ( fa < 0 && fb > 0 )
+                roots[n++] = details::polynomial_roots<scalar_type, 2 * N - 2>::refine(f, df, ends[i - 1], ends[i], fa);
+
+            fa = fb;
+        }
+
+        parameter_type tc = 0;
+        scalar_type dc = -1;
+        for ( size_type i = 0; i < n + 2; i++ )
+        {
+            const scalar_type ti = (i < n) ? roots[i] : scalar_type(i - n);
+
+            scalar_type di = 0;
+            for ( size_type d = 0; d < traits::dimension; d++ )
+            {
+                const scalar_type x = details::horner(c[d], N, ti);
+                di += x * x;
+            }
+
+            if ( di < dc || dc < 0 )
+            {
+                dc = di;
+                tc = ti;
+            }
+        }
+
+        if ( t )
+            *t = tc;
+
+        return sqrt(dc);
+    }
+
+#undef TE
+#undef ME
+
+    // ================================================================
+    // spline_localization class template
+    // Implementation
+
+#define TE template < class Base, class S >
+#define ME spline_localization<Base, S>::
+
+    // ----------------------------------------------------------------
+    TE typename ME parameter_type ME distance ( value_type p, parameter_type * t ) const
+    {
+        return this->distance(p, t, localization_golden_section());
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class Mode > typename ME parameter_type ME distance ( value_type p, parameter_type * t, Mode mode ) const
+    {
+        return this->closest(p, t, mode, this->size(), 0, details::bool_constant<(value_traits<value_type>::dimension > 0)>());
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt, class OutD, class OutT > void ME distance( InIt first, InIt last, OutD out_d, OutT out_t ) const
+    {
+        this->distance(first, last, out_d, out_t, localization_golden_section());
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt, class OutD, class OutT, class Mode > void ME distance( InIt first, InIt last, OutD out_d, OutT out_t, Mode mode ) const
+    {
+        const details::bool_constant<(value_traits<value_type>::dimension > 0)> indexed;
+
+        // closest point of the next point is expected near the previous one
+        size_type hint = this->size();
+        parameter_type radius = 0;
+
+        for ( ; first != last; ++first )
+        {
+            parameter_type t = 0;
+            const parameter_type d = this->closest(*first, &t, mode, hint, 2 * radius, indexed);
+            *out_d++ = d;
+            *out_t++ = t;
+
+            hint = std::min(size_type(t), this->size() - 1);
+            radius = d;
+        }
+    }
+
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Chunk of batch distance request
+        template < class Spline, class RanIt, class OutD, class OutT, class Mode >
+            struct batch_distance_task
+        {
+            batch_distance_task( const Spline & s, RanIt first, OutD out_d, OutT out_t, Mode mode )
+                : s_(s), first_(first), out_d_(out_d), out_t_(out_t), mode_(mode) {}
+
+            void operator() ( size_type from, size_type to ) const
+            {
+                s_.distance(first_ + from, first_ + to, out_d_ + from, out_t_ + from, mode_);
+            }
+
+        private:
+            const Spline & s_;
+            RanIt first_;
+            OutD out_d_;
+            OutT out_t_;
+            Mode mode_;
+        };
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class Pool, class RanIt, class OutD, class OutT > void ME distance( Pool & pool, RanIt first, RanIt last, OutD out_d, OutT out_t, size_type grain ) const
+    {
+        this->distance(pool, first, last, out_d, out_t, grain, localization_golden_section());
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class Pool, class RanIt, class OutD, class OutT, class Mode > void ME distance( Pool & pool, RanIt first, RanIt last, OutD out_d, OutT out_t, size_type grain, Mode mode ) const
+    {
+        // aabb-tree should be built before it's shared between threads, caches of other decorators aren't used
+        this->prepare(details::bool_constant<(value_traits<value_type>::dimension > 0)>());
+
+        pool.parallel_for(last - first, grain, details::batch_distance_task<spline_localization, RanIt, OutD, OutT, Mode>(*this, first, out_d, out_t, mode));
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class Mode > typename ME parameter_type ME closest ( value_type p, parameter_type * t, Mode mode, size_type, parameter_type, details::bool_constant<false> ) const
+    {
+        parameter_type mt = 0, md = -1;
+        for ( size_type i = 0; i < this->size(); i++ )
+        {
+            parameter_type t;
+            parameter_type d = this->segment_distance(i, p, &t, mode);
+            if ( d < md || md == -1 )
+            {
+                md = d;
+                mt = i + t;
+            }
+        }
+
+        if ( t )
+            *t = mt;
+
+        return md;
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class Mode > typename ME parameter_type ME closest ( value_type p, parameter_type * t, Mode mode, size_type hint, parameter_type radius, details::bool_constant<true> ) const
+    {
+        const aabb_tree_type & tree = this->aabb_tree();
+        const size_type blocks = tree.blocks.size();
+
+        parameter_type mt = 0, md = -1, md2 = 0;
+
+        // depth-first traversal of nodes [from, to) of tree over blocks (top) and trees over segments of blocks,
+        // the closer child is visited first
+        typedef details::aabb_range range;
+        range stack[128];
+        size_type depth = 0;
+
+        if ( hint < this->size() )
+        {
+            // siblings of nodes on the path to the hint leaf are checked starting with the deepest one,
+            // distance to hint segment bounds search area
+            const size_type hint_block = tree.blocks.find(hint);
+            range r = { 0, blocks, true };
+
+            while ( r.to - r.from > 1 || r.top )
+            {
+                if ( r.to - r.from == 1 )
+                {
+                    const range b = { tree.blocks.begin(r.from), tree.blocks.end(r.from), false };
+                    r = b;
+                    continue;
+                }
+
+                const size_type c = r.from + (r.to - r.from) / 2;
+                const range sibling = { (r.top ? hint_block : hint) < c ? c : r.from, (r.top ? hint_block : hint) < c ? r.to : c, r.top };
+                stack[depth++] = sibling;
+
+                if ( sibling.from == c )
+                    r.to = c;
+                else
+                    r.from = c;
+            }
+
+            if ( details::aabb_distance_sqr(p, tree.nodes[hint].min, tree.nodes[hint].max) <= radius * radius )
+            {
+                parameter_type st;
+                md = this->segment_distance(hint, p, &st, mode);
+                md2 = md * md;
+                mt = hint + st;
+            }
+            else
+                depth = 0;
+        }
+
+        if ( md < 0 && blocks > 0 )
+        {
+            const range root = { 0, blocks, true };
+            stack[depth++] = root;
+        }
+
+        while ( depth > 0 )
+        {
+            const range r = stack[--depth];
+
+            const value_type * min, * max;
+            if ( r.top )
+                details::aabb_box(tree.top, r.from, r.to, &min, &max);
+            else
+                details::aabb_box(tree.nodes, r.from, r.to, &min, &max);
+
+            if ( md >= 0 && details::aabb_distance_sqr(p, *min, *max) >= md2 )
+                continue;
+
+            if ( r.to - r.from == 1 )
+            {
+                if ( r.top )
+                {
+                    const range b = { tree.blocks.begin(r.from), tree.blocks.end(r.from), false };
+                    stack[depth++] = b;
+                    continue;
+                }
+
+                parameter_type st;
+                parameter_type d = this->segment_distance(r.from, p, &st, mode);
+                if ( d < md || md == -1 )
+                {
+                    md = d;
+                    md2 = d * d;
+                    mt = r.from + st;
+                }
+
+                continue;
+            }
+
+            const size_type c = r.from + (r.to - r.from) / 2;
+            range l = { r.from, c, r.top }, h = { c, r.to, r.top };
+
+            const value_type * lmin, * lmax, * hmin, * hmax;
+            if ( r.top )
+            {
+                details::aabb_box(tree.top, l.from, l.to, &lmin, &lmax);
+                details::aabb_box(tree.top, h.from, h.to, &hmin, &hmax);
+            }
+            else
+            {
+                details::aabb_box(tree.nodes, l.from, l.to, &lmin, &lmax);
+                details::aabb_box(tree.nodes, h.from, h.to, &hmin, &hmax);
+            }
+
+            if ( details::aabb_distance_sqr(p, *hmin, *hmax) < details::aabb_distance_sqr(p, *lmin, *lmax) )
+                std::swap(l, h);
+
+            stack[depth++] = h;
+            stack[depth++] = l;
+        }
+
+        if ( t )
+            *t = mt;
+
+        return md;
+    }
+
+    // ----------------------------------------------------------------
+    TE const typename ME aabb_tree_type & ME aabb_tree() const
+    {
+        if ( m_Tree.valid && m_Tree.revision == this->revision() )
+            return m_Tree;
+
+        const size_type n = this->size();
+
+        size_type head = 0, tail = 0;
+        if ( !m_Tree.valid || !this->changed_since(m_Tree.revision, &head, &tail) )
+        {
+            m_Tree.blocks.reset(this->get_allocator());
+            details::adopt_allocator(m_Tree.nodes, this->get_allocator());
+            details::adopt_allocator(m_Tree.top, this->get_allocator());
+            head = tail = 0;
+        }
+
+        // boxes of segments which weren't replaced are kept
+        const size_type old_n = m_Tree.nodes.size();
+        size_type first, last;
+        m_Tree.blocks.affected(head, old_n - tail, n - tail - head, cache_block, &first, &last);
+        details::splice(m_Tree.nodes, head, old_n - tail, n - tail - head);
+
+        if ( n != old_n )
+            last = m_Tree.blocks.split(first, last, m_Tree.blocks.begin(last) + n - old_n - m_Tree.blocks.begin(first), cache_block);
+
+        for ( size_type i = head; i < n - tail; i++ )
+        {
+            details::aabb_node<value_type> & node = m_Tree.nodes[i];
+            (*this)[i].get_aabb(&node.min, &node.max);
+        }
+
+        // shape of tree of block depends on number of its segments only
+        for ( size_type b = first; b < last; b++ )
+        {
+            if ( n == old_n )
+                details::aabb_build(m_Tree.nodes, m_Tree.blocks.begin(b), m_Tree.blocks.end(b), head, n - tail);
+            else
+                details::aabb_build(m_Tree.nodes, m_Tree.blocks.begin(b), m_Tree.blocks.end(b));
+        }
+
+        const aabb_nodes_type & nodes = m_Tree.nodes;
+        m_Tree.top.resize(m_Tree.blocks.size());
+
+        for ( size_type b = 0; b < m_Tree.blocks.size(); b++ )
+        {
+            const value_type * min, * max;
+            details::aabb_box(nodes, m_Tree.blocks.begin(b), m_Tree.blocks.end(b), &min, &max);
+            m_Tree.top[b].min = *min;
+            m_Tree.top[b].max = *max;
+        }
+
+        details::aabb_build(m_Tree.top, 0, m_Tree.top.size());
+
+        m_Tree.revision = this->revision();
+        m_Tree.valid = true;
+
+        return m_Tree;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME prepare() const
+    {
+        Base::template apply<S>::type::prepare();
+        this->prepare(details::bool_constant<(value_traits<value_type>::dimension > 0)>());
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME get_aabb( value_type * min, value_type * max ) const
+    {
+        const aabb_tree_type & tree = this->aabb_tree();
+
+        if ( tree.top.empty() )
+            throw spline_empty_exception("");
+
+        const value_type * pmin, * pmax;
+        details::aabb_box(tree.top, 0, tree.top.size(), &pmin, &pmax);
+
+        *min = *pmin;
+        *max = *pmax;
+    }
+
+    // ----------------------------------------------------------------
+    TE bool ME intersect( value_type s0, value_type s1, parameter_type * t ) const
+    {
+        parameter_type mt = 0, md = -1;
+        for ( size_type i = 0; i < this->size(); i++ )
+        {
+            parameter_type t;
+            if ( (*this)[i].intersect(s0, s1, &t) )
+            {
+                parameter_type d = details::norm_(s0 - (*this)[i](t));
+                if ( d < md || md == -1 )
+                {
+                    md = d;
+                    mt = i + t;
+                }
+            }
+        }
+
+        if ( t )
+            *t = mt;
+
+        return md != -1;
+    }
+
+#undef TE
+#undef ME
+
+}
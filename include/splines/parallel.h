@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Parallel spline algorithms (requires C++11)
+/// Pool is any type which provides parallel_for(count, grain, fn), see thread_pool.h
+///
+/// Results are identical to the serial algorithms: segments are processed in chunks of 'grain'
+/// segments into separate buffers which are concatenated in segments order.
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+
+#include "splines_aux.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// Wall-clock time of parallel algorithm phases, in seconds
+    struct parallel_timing
+    {
+        parallel_timing() : process(0), concatenate(0) {}
+
+        double process;     ///< Segments processing into chunk buffers
+        double concatenate; ///< Copying of chunk buffers to the output
+    };
+
+    // ----------------------------------------------------------------
+    /// Parallel spline::approximate, output is the same as spline.approximate(accuracy, out)
+    template < class Pool, class Spline, class OutPtIt >
+        OutPtIt parallel_approximate( Pool & pool, const Spline & spline, typename Spline::parameter_type accuracy, OutPtIt out,
+                                      size_type grain = 1024, parallel_timing * timing = 0 );
+
+    // ----------------------------------------------------------------
+    /// Parallel spline::approximate_predicted, output is the same as spline.approximate_predicted(accuracy, out)
+    template < class Pool, class Spline, class OutPtIt >
+        OutPtIt parallel_approximate_predicted( Pool & pool, const Spline & spline, typename Spline::parameter_type accuracy, OutPtIt out,
+                                                size_type grain = 1024, parallel_timing * timing = 0 );
+
+    // ================================================================
+    // Implementation
+
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Process segments of spline in chunks of 'grain' segments by fn(segment, back_inserter(buffer)),
+        /// then copy buffers to the output in segments order
+        template < class Pool, class Spline, class OutPtIt, class Fn >
+            OutPtIt parallel_segments( Pool & pool, const Spline & spline, OutPtIt out, size_type grain, parallel_timing * timing, Fn fn )
+        {
+            typedef typename Spline::value_type value_type;
+            typedef std::chrono::steady_clock clock;
+
+            grain = std::max(size_type(1), grain);
+
+            const clock::time_point start = clock::now();
+
+            // pool splits indices of chunks, so every buffer is filled by a single call however the range is split
+            const size_type size = spline.size();
+            std::vector< std::vector<value_type> > buffers((size + grain - 1) / grain);
+
+            pool.parallel_for(buffers.size(), 1, [&spline, &buffers, &fn, grain, size] ( size_type from, size_type to )
+            {
+                for ( size_type k = from; k < to; k++ )
+                {
+                    std::vector<value_type> & buffer = buffers[k];
+                    for ( size_type i = k * grain, end = std::min(size, (k + 1) * grain); i < end; i++ )
+                        fn(spline[i], std::back_inserter(buffer));
+                }
+            });
+
+            const clock::time_point processed = clock::now();
+
+            for ( size_type i = 0; i < buffers.size(); i++ )
+                out = std::copy(buffers[i].begin(), buffers[i].end(), out);
+
+            if ( timing )
+            {
+                timing->process = std::chrono::duration<double>(processed - start).count();
+                timing->concatenate = std::chrono::duration<double>(clock::now() - processed).count();
+            }
+
+            return out;
+        }
+    }
+
+    // ----------------------------------------------------------------
+    template < class Pool, class Spline, class OutPtIt >
+        OutPtIt parallel_approximate( Pool & pool, const Spline & spline, typename Spline::parameter_type accuracy, OutPtIt out,
+                                      size_type grain, parallel_timing * timing )
+    {
+        typedef typename Spline::segment_type segment_type;
+        typedef std::back_insert_iterator< std::vector<typename Spline::value_type> > buffer_iterator;
+
+        return details::parallel_segments(pool, spline, out, grain, timing, [accuracy] ( const segment_type & seg, buffer_iterator it )
+        {
+            seg.approximate(accuracy, it);
+        });
+    }
+
+    // ----------------------------------------------------------------
+    template < class Pool, class Spline, class OutPtIt >
+        OutPtIt parallel_approximate_predicted( Pool & pool, const Spline & spline, typename Spline::parameter_type accuracy, OutPtIt out,
+                                                size_type grain, parallel_timing * timing )
+    {
+        typedef typename Spline::segment_type segment_type;
+        typedef std::back_insert_iterator< std::vector<typename Spline::value_type> > buffer_iterator;
+
+        return details::parallel_segments(pool, spline, out, grain, timing, [accuracy] ( const segment_type & seg, buffer_iterator it )
+        {
+            seg.approximate_predicted(accuracy, it);
+        });
+    }
+}
@@ -1,253 +1,553 @@
-///////////////////////////////////////////////////////////////////////////////
-/// segment class template definition
-
-#pragma once
-
-#include <utility>
-#include <algorithm>
-#include <numeric>
-
-#include "splines_aux.h"
-
-namespace gsl
-{
-    // ----------------------------------------------------------------
-    /// segment class template
-    ///     Performs interpolation in range [0, 1]
-    ///     If parameter is out of range value will be extrapolated
-    template < typename T, typename U, size_type D >
-        class segment
-    {
-    public:
-        static const size_type Degree = D; ///< Segment degree (0 - const, 1 - linear, 3 cubic, ...)
-
-        typedef T parameter_type; ///< Some real type expected to be parameter type
-        typedef U value_type; ///< Some vector value expected
-
-    public:
-        /// Default constructor
-        segment();
-
-        /// Constructor by coefficients
-        template < typename InIt >
-            segment( InIt first, InIt last );
-
-        /// Obtain origin = s(0) and ending = s(1) values
-        value_type origin() const;
-        value_type ending() const;
-
-        /// Obtain interpolated value
-        value_type operator() ( parameter_type t ) const;
-
-        /// Obtain 'K' derivative value
-        template < size_type K > 
-            value_type derivative( parameter_type t ) const;
-
-        /// Approximate segment with polyline
-        template < class OutPtIt >
-            void approximate ( parameter_type accuracy, OutPtIt out ) const;
-
-        /// Obtain curvature
-        parameter_type curvature( parameter_type t ) const;
-
-        /// Obtain curvature radius
-        parameter_type radius( parameter_type t ) const;
-
-        /// Obtain torsion
-        parameter_type torsion( parameter_type t ) const;
-
-        /// Obtain torsion radius
-        parameter_type torsion_radius( parameter_type t ) const;
-
-        /// Obtain direction
-        value_type direction( parameter_type t ) const;
-
-        /// Obtain normal
-        value_type normal( parameter_type t ) const;
-
-        /// Obtain binormal
-        value_type binormal( parameter_type t ) const;
-
-    private:
-        /// Approximate segment with polyline
-        template < class OutPtIt >
-            void approximate( parameter_type t0, parameter_type t1, const value_type & p0, const value_type & p1, parameter_type accuracy, OutPtIt out ) const;
-
-    protected:
-        value_type m_Coefs[Degree + 1];
-    };
-
-    // ================================================================
-    // segment class template
-    // Implementation
-
-#define TE template < typename T, typename U, size_type D >
-#define ME segment<T, U, D>::
-
-    // ----------------------------------------------------------------
-    TE ME segment()
-    {
-        std::fill_n(m_Coefs, Degree + 1, U());
-    }
-
-    // ----------------------------------------------------------------
-    TE template < typename InIt > ME segment( InIt first, InIt last )
-    {
-        //std::copy(first, std::min(last, first + Degree + 1), m_Coefs);
-        std::copy(first, last, m_Coefs);
-    }
-
-    // ----------------------------------------------------------------
-    TE U ME origin() const
-    {
-      return m_Coefs[0];
-    }
-
-    // ----------------------------------------------------------------
-    TE U ME ending() const
-    {
-      return std::accumulate(m_Coefs, m_Coefs + Degree + 1, U());
-    }
-
-    // ----------------------------------------------------------------
-    TE U ME operator() ( T t ) const
-    {
-        T tt = t;
-        U ret = m_Coefs[0];
-
-        for ( size_type i = 1; i <= Degree; i++, tt *= t )
-            ret += tt * m_Coefs[i];
-
-        return ret;
-    }
-
-    // ----------------------------------------------------------------
-    // (a0 + a1*t + a2 * t^2 + a3 * t^3 + ... + an * t^n)'k =
-    //      = k! * ak + (k+1)!/2 + ... + n!/(n-k)! * an * t^(n-k)
-    TE template < size_type Deg >
-        U ME derivative( T t ) const
-    {
-        T tt = 1;
-        U ret = U();
-
-        for ( size_type i = Deg; i <= Degree; i++, tt *= t )
-        {
-            T coef = details::d_coef(i, Deg);
-            ret += (tt * coef) * m_Coefs[i];
-        }
-
-        return ret;
-    }
-
-    // ----------------------------------------------------------------
-    // Obtain curvature
-    /// @todo check
-    TE T ME curvature( T t ) const
-    {
-      U d1 = this->derivative<1>(t);
-      U d2 = this->derivative<2>(t);
-      T nd1 = details::norm_(d1);
-      return details::norm_(cross(d1, d2)) / (nd1 * nd1 * nd1);
-    }
-
-    // Obtain curvature radius
-    TE T ME radius( T t ) const
-    {
-        U d1 = this->derivative<1>(t);
-        U d2 = this->derivative<2>(t);
-        T nd1 = details::norm_(d1);
-        return (nd1 * nd1 * nd1) / details::norm_(cross(d1, d2));
-    }
-
-    /// Obtain torsion
-    TE T ME torsion( T t ) const
-    {
-        return 0; // todo: implement
-    }
-
-    /// Obtain torsion radius
-    TE T ME torsion_radius( T t ) const
-    {
-        return 1 / this->torsion(t);
-    }
-
-    /// Obtain direction
-    /// Use normalized first derivative or try next derivative if previous is zero
-    template < size_type N > struct obtain_direction
-    {
-      TE static U apply( const segment<T, U, D> & s, T t )
-      {
-        U dir = s.template derivative<D - N>(t);
-        T l = details::norm_(dir);
-
-        return details::eq_zero(l) ? obtain_direction<N - 1>::apply(s, t) : details::normalized_(dir);
-      }
-    };
-    template <> struct obtain_direction<0>
-    {
-      TE static U apply( const segment<T, U, D> & s, T )
-      {
-        return s.ending() - s.origin();
-      }
-    };
-
-    TE U ME direction( T t ) const
-    {
-        return obtain_direction<D - 1>::apply(*this, t);
-    }
-
-    /// Obtain normal
-    TE U ME normal( T t ) const
-    {
-        return details::perp_(this->direction(t)); // todo: implement
-    }
-
-    /// Obtain binormal
-    TE U ME binormal( T t ) const
-    {
-        return this->direction(t) ^ this->normal(t);
-    }
-
-    /// Approximate segment with polyline
-    TE template < class OutPtIt > void ME approximate ( T accuracy, OutPtIt out ) const
-    {
-      /// @todo nonrecursive 
-      const size_type NSubDiv = 5;
-      
-      T t0 = 0;
-      U p0 = (*this)(t0);
-      
-      for ( size_type i = 1; i <= NSubDiv; i++ )
-      {
-        T t1 = i / T(NSubDiv);
-        U p1 = (*this)(t1);
-        this->approximate(t0, t1, p0, p1, accuracy, out);
-        p0 = p1;
-        t0 = t1;
-      }
-
-      *out++ = p0;
-    }
-
-    /// Approximate segment with polyline
-    TE template < class OutPtIt > void ME approximate( T t0, T t1, const U & p0, const U & p1, T accuracy, OutPtIt out ) const
-    {
-      T t = (t0 + t1) / 2;
-      U p = (*this)(t);
-      U pc = (p0 + p1) / 2; /// @todo: use distance(line_segment(p0,p1), p) instead, use double-checked estimate
-
-      if ( details::norm_(p - pc) < accuracy )
-      {
-        *out++ = p0;
-        return;
-      }
-
-      this->approximate(t0, t, p0, p, accuracy, out);
-      this->approximate(t, t1, p, p1, accuracy, out);
-    }
-
-
-#undef TE
-#undef ME
-
-}
+///////////////////////////////////////////////////////////////////////////////
+/// segment class template definition
+
+#pragma once
+
+#include <utility>
+#include <algorithm>
+#include <numeric>
+
+#include "splines_aux.h"
+#include "simd.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// segment_jet class template
+    ///     Value and derivatives 1..K of segment evaluated at the same parameter
+    template < typename T, typename U, size_type K >
+        struct segment_jet
+    {
+        static const size_type Order = K; ///< Highest derivative order
+
+        typedef T parameter_type;
+        typedef U value_type;
+
+        /// Obtain 'k' derivative value (k = 0 - interpolated value)
+        const value_type & operator[] ( size_type k ) const { return d[k]; }
+
+        /// Index of the first nonzero derivative (0 if all derivatives 1..K are zero)
+        size_type leading() const;
+
+        /// Obtain curvature (K >= 2 required)
+        parameter_type curvature() const;
+
+        /// Obtain curvature radius (K >= 2 required)
+        parameter_type radius() const;
+
+        /// Obtain direction (normalized first nonzero derivative)
+        value_type direction() const;
+
+        /// Obtain normal
+        value_type normal() const;
+
+        value_type d[K + 1];
+    };
+
+    // ----------------------------------------------------------------
+    /// segment class template
+    ///     Performs interpolation in range [0, 1]
+    ///     If parameter is out of range value will be extrapolated
+    template < typename T, typename U, size_type D >
+        class segment
+    {
+    public:
+        static const size_type Degree = D; ///< Segment degree (0 - const, 1 - linear, 3 cubic, ...)
+        static const size_type ApproximationDepth = 16; ///< Maximum number of approximate() subdivisions
+
+        typedef T parameter_type; ///< Some real type expected to be parameter type
+        typedef U value_type; ///< Some vector value expected
+
+    public:
+        /// Default constructor
+        segment();
+
+        /// Constructor by coefficients
+        template < typename InIt >
+            segment( InIt first, InIt last );
+
+        /// Polynomial coefficients a0..aD: s(t) = a0 + a1*t + ... + aD*t^D
+        const value_type * coefficients() const { return m_Coefs; }
+
+        /// Obtain origin = s(0) and ending = s(1) values
+        value_type origin() const;
+        value_type ending() const;
+
+        /// Obtain interpolated value
+        value_type operator() ( parameter_type t ) const;
+
+        /// Obtain 'K' derivative value
+        template < size_type K > 
+            value_type derivative( parameter_type t ) const;
+
+        /// Obtain value and derivatives 1..K in a single pass
+        template < size_type K >
+            segment_jet<parameter_type, value_type, K> evaluate_jet( parameter_type t ) const;
+
+        /// Obtain interpolated values for parameters [first, last)
+        void evaluate( const parameter_type * first, const parameter_type * last, value_type * out ) const;
+
+        /// Obtain 'K' derivative values for parameters [first, last)
+        template < size_type K >
+            void derivative( const parameter_type * first, const parameter_type * last, value_type * out ) const;
+
+        /// Approximate segment with polyline: distance from curve to chords is less than accuracy
+        /// (checked at middle and quarter points of chords). Polyline includes segment ending
+        template < class OutPtIt >
+            OutPtIt approximate ( parameter_type accuracy, OutPtIt out ) const;
+
+        /// Approximate segment with polyline to the buffer, return number of polyline points.
+        /// If it's greater than capacity, only first 'capacity' points are written
+        size_type approximate ( parameter_type accuracy, value_type * buffer, size_type capacity ) const;
+
+        /// Approximate segment with polyline at uniform parameters. Number of chords n is predicted
+        /// by Wang's formula: distance from curve to chords <= max|s''| / (8 * n^2), max|s''| is bounded
+        /// by Bernstein coefficients of s''. Points are evaluated by batch kernel (see evaluate).
+        /// Polyline includes segment ending
+        template < class OutPtIt >
+            OutPtIt approximate_predicted ( parameter_type accuracy, OutPtIt out ) const;
+
+        /// Number of polyline points of approximate_predicted
+        size_type predict_approximation ( parameter_type accuracy ) const;
+
+        /// Obtain n + 1 values at uniform parameters i/n by forward differencing (Degree additions per value)
+        /// Difference table is recomputed every 'reanchor' values to bound error accumulation (0 - never)
+        template < class OutPtIt >
+            void sample_uniform ( size_type n, OutPtIt out, size_type reanchor = 0 ) const;
+
+        /// Obtain curvature
+        parameter_type curvature( parameter_type t ) const;
+
+        /// Obtain curvature radius
+        parameter_type radius( parameter_type t ) const;
+
+        /// Obtain torsion
+        parameter_type torsion( parameter_type t ) const;
+
+        /// Obtain torsion radius
+        parameter_type torsion_radius( parameter_type t ) const;
+
+        /// Obtain direction
+        value_type direction( parameter_type t ) const;
+
+        /// Obtain normal
+        value_type normal( parameter_type t ) const;
+
+        /// Obtain binormal
+        value_type binormal( parameter_type t ) const;
+
+    protected:
+        value_type m_Coefs[Degree + 1];
+    };
+
+    // ================================================================
+    // segment_jet class template
+    // Implementation
+
+#define TE template < typename T, typename U, size_type K >
+#define ME segment_jet<T, U, K>::
+
+    // ----------------------------------------------------------------
+    TE size_type ME leading() const
+    {
+        for ( size_type k = 1; k <= K; k++ )
+            if ( !details::eq_zero(details::norm_(d[k])) )
+                return k;
+
+        return 0;
+    }
+
+    // ----------------------------------------------------------------
+    TE T ME curvature() const
+    {
+        T nd1 = details::norm_(d[1]);
+        return details::norm_(cross(d[1], d[2])) / (nd1 * nd1 * nd1);
+    }
+
+    // ----------------------------------------------------------------
+    TE T ME radius() const
+    {
+        T nd1 = details::norm_(d[1]);
+        return (nd1 * nd1 * nd1) / details::norm_(cross(d[1], d[2]));
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME direction() const
+    {
+        const size_type k = this->leading();
+        return k ? details::normalized_(d[k]) : U();
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME normal() const
+    {
+        return details::perp_(this->direction());
+    }
+
+#undef TE
+#undef ME
+
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Forward differences table of polynomial segment with constant parameter step:
+        ///     d[0] = s(t), d[k] - k-th forward difference at t, d[D] is constant
+        template < class Seg >
+            class forward_differences
+        {
+            typedef typename Seg::parameter_type parameter_type;
+            typedef typename Seg::value_type value_type;
+
+        public:
+            forward_differences( const Seg & s, parameter_type t, parameter_type h ) { reset(s, t, h); }
+
+            /// Recompute table at parameter 't' from exact values
+            void reset( const Seg & s, parameter_type t, parameter_type h )
+            {
+                for ( size_type k = 0; k <= Seg::Degree; k++ )
+                    d[k] = s(t + k * h);
+
+                for ( size_type k = 1; k <= Seg::Degree; k++ )
+                    for ( size_type j = Seg::Degree; j >= k; j-- )
+                        d[j] -= d[j - 1];
+            }
+
+            /// Current value
+            const value_type & value() const { return d[0]; }
+
+            /// Move to the next parameter t + h
+            void step()
+            {
+                for ( size_type k = 0; k < Seg::Degree; k++ )
+                    d[k] += d[k + 1];
+            }
+
+        private:
+            value_type d[Seg::Degree + 1];
+        };
+
+        // ----------------------------------------------------------------
+        /// Write 'count' values of segment at parameters i/n, i = 0..count-1
+        template < class Seg, class OutPtIt >
+            OutPtIt sample_uniform( const Seg & s, size_type n, size_type count, size_type reanchor, OutPtIt out )
+        {
+            typedef typename Seg::parameter_type parameter_type;
+
+            const parameter_type h = parameter_type(1) / n;
+            forward_differences<Seg> fd(s, 0, h);
+
+            for ( size_type i = 0, left = reanchor; i < count; i++, left-- )
+            {
+                if ( reanchor && !left )
+                {
+                    fd.reset(s, parameter_type(i) / n, h);
+                    left = reanchor;
+                }
+
+                *out++ = fd.value();
+                fd.step();
+            }
+
+            return out;
+        }
+    }
+
+    // ================================================================
+    // segment class template
+    // Implementation
+
+#define TE template < typename T, typename U, size_type D >
+#define ME segment<T, U, D>::
+
+    // ----------------------------------------------------------------
+    TE ME segment()
+    {
+        std::fill_n(m_Coefs, Degree + 1, U());
+    }
+
+    // ----------------------------------------------------------------
+    TE template < typename InIt > ME segment( InIt first, InIt last )
+    {
+        //std::copy(first, std::min(last, first + Degree + 1), m_Coefs);
+        std::copy(first, last, m_Coefs);
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME origin() const
+    {
+      return m_Coefs[0];
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME ending() const
+    {
+      return std::accumulate(m_Coefs, m_Coefs + Degree + 1, U());
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME operator() ( T t ) const
+    {
+        T tt = t;
+        U ret = m_Coefs[0];
+
+        for ( size_type i = 1; i <= Degree; i++, tt *= t )
+            ret += tt * m_Coefs[i];
+
+        return ret;
+    }
+
+    // ----------------------------------------------------------------
+    // (a0 + a1*t + a2 * t^2 + a3 * t^3 + ... + an * t^n)'k =
+    //      = k! * ak + (k+1)!/2 + ... + n!/(n-k)! * an * t^(n-k)
+    // Horner scheme, coefficient n!/(n-k)! is updated incrementally
+    TE template < size_type Deg >
+        U ME derivative( T t ) const
+    {
+        if ( Deg > Degree )
+            return U();
+
+        size_type coef = details::d_coef(Degree, Deg);
+        U ret = T(coef) * m_Coefs[Degree];
+
+        for ( size_type i = Degree; i > Deg; i-- )
+        {
+            coef = coef * (i - Deg) / i; // i!/(i-k)! -> (i-1)!/(i-1-k)!
+            ret = t * ret + T(coef) * m_Coefs[i - 1];
+        }
+
+        return ret;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME evaluate( const T * first, const T * last, U * out ) const
+    {
+        this->template derivative<0>(first, last, out);
+    }
+
+    // ----------------------------------------------------------------
+    // Coefficients of 'K' derivative polynomial are obtained once, then it is evaluated
+    // for all parameters with batch kernel
+    TE template < size_type K >
+        void ME derivative( const T * first, const T * last, U * out ) const
+    {
+        static const size_type N = (K > Degree) ? 1 : Degree - K + 1;
+
+        U c[N];
+        size_type coef = details::d_coef(K, K);
+        for ( size_type i = 0; i < N; i++ )
+        {
+            c[i] = (K > Degree) ? U() : T(coef) * m_Coefs[i + K];
+            coef = coef * (i + K + 1) / (i + 1); // (i+k)!/i! -> (i+1+k)!/(i+1)!
+        }
+
+        details::polynomial_evaluator<T, U, N>::apply(c, first, last - first, out);
+    }
+
+    // ----------------------------------------------------------------
+    // Taylor shift by repeated synthetic division: after k-th pass c[k] = s^(k)(t) / k!
+    TE template < size_type K >
+        segment_jet<T, U, K> ME evaluate_jet( T t ) const
+    {
+        segment_jet<T, U, K> ret;
+
+        U c[Degree + 1];
+        std::copy(m_Coefs, m_Coefs + Degree + 1, c);
+
+        T fac = 1;
+        for ( size_type k = 0; k <= K && k <= Degree; k++ )
+        {
+            for ( size_type i = Degree; i > k; i-- )
+                c[i - 1] += t * c[i];
+
+            ret.d[k] = fac * c[k];
+            fac *= T(k + 1);
+        }
+
+        for ( size_type k = Degree + 1; k <= K; k++ )
+            ret.d[k] = U();
+
+        return ret;
+    }
+
+    // ----------------------------------------------------------------
+    // Obtain curvature
+    /// @todo check
+    TE T ME curvature( T t ) const
+    {
+        return this->template evaluate_jet<2>(t).curvature();
+    }
+
+    // Obtain curvature radius
+    TE T ME radius( T t ) const
+    {
+        return this->template evaluate_jet<2>(t).radius();
+    }
+
+    /// Obtain torsion
+    TE T ME torsion( T t ) const
+    {
+        return 0; // todo: implement
+    }
+
+    /// Obtain torsion radius
+    TE T ME torsion_radius( T t ) const
+    {
+        return 1 / this->torsion(t);
+    }
+
+    /// Obtain direction
+    /// Use normalized first derivative or try next derivative if previous is zero
+    TE U ME direction( T t ) const
+    {
+        const segment_jet<T, U, D - 1> jet = this->template evaluate_jet<D - 1>(t);
+        const size_type k = jet.leading();
+
+        return k ? details::normalized_(jet[k]) : this->ending() - this->origin();
+    }
+
+    /// Obtain normal
+    TE U ME normal( T t ) const
+    {
+        return details::perp_(this->direction(t)); // todo: implement
+    }
+
+    /// Obtain binormal
+    TE U ME binormal( T t ) const
+    {
+        return this->direction(t) ^ this->normal(t);
+    }
+
+    /// Approximate segment with polyline
+    ///     Intervals are processed in order with explicit stack of right halves (stack depth is
+    ///     limited by ApproximationDepth), middle point of every interval is known from its parent
+    TE template < class OutPtIt > OutPtIt ME approximate ( T accuracy, OutPtIt out ) const
+    {
+        struct interval
+        {
+            T t1;
+            U p1, pm;
+            size_type depth;
+        };
+
+        interval stack[ApproximationDepth + 1];
+        size_type top = 1;
+
+        T t0 = 0;
+        U p0 = this->origin();
+
+        stack[0].t1 = 1;
+        stack[0].p1 = this->ending();
+        stack[0].pm = (*this)(T(0.5));
+        stack[0].depth = 0;
+
+        while ( top )
+        {
+            interval & cur = stack[top - 1];
+
+            const T tm = (t0 + cur.t1) / 2;
+            const U q0 = (*this)((t0 + tm) / 2);
+            const U q1 = (*this)((tm + cur.t1) / 2);
+
+            // the first split is forced, so loops which return to the chord aren't skipped.
+            // Distance of middle point from the chord middle is bounded too: curve which overshoots
+            // chord ending and turns back between checked points is far from it
+            if ( cur.depth == ApproximationDepth ||
+                 (cur.depth > 0 &&
+                  details::norm_(cur.pm - (p0 + cur.p1) / 2) < 2 * accuracy &&
+                  details::chord_distance_(cur.pm, p0, cur.p1) < accuracy &&
+                  details::chord_distance_(q0, p0, cur.p1) < accuracy &&
+                  details::chord_distance_(q1, p0, cur.p1) < accuracy) )
+            {
+                *out++ = p0;
+                t0 = cur.t1;
+                p0 = cur.p1;
+                --top;
+                continue;
+            }
+
+            // right half replaces interval, left half is processed first
+            interval & left = stack[top++];
+            left.t1 = tm;
+            left.p1 = cur.pm;
+            left.pm = q0;
+            left.depth = ++cur.depth;
+
+            cur.pm = q1;
+        }
+
+        *out++ = p0;
+        return out;
+    }
+
+    /// Approximate segment with polyline to the buffer
+    TE size_type ME approximate ( T accuracy, U * buffer, size_type capacity ) const
+    {
+        return this->approximate(accuracy, details::bounded_output_iterator<U>(buffer, capacity)).count();
+    }
+
+    /// Approximate segment with polyline at uniform parameters
+    TE template < class OutPtIt > OutPtIt ME approximate_predicted ( T accuracy, OutPtIt out ) const
+    {
+        const size_type BlockSize = 256;
+        const size_type n = this->predict_approximation(accuracy) - 1;
+
+        T ts[BlockSize];
+        U vals[BlockSize];
+
+        for ( size_type b = 0; b < n; b += BlockSize )
+        {
+            const size_type m = std::min(BlockSize, n - b);
+            for ( size_type j = 0; j < m; j++ )
+                ts[j] = T(b + j) / n;
+
+            this->evaluate(ts, ts + m, vals);
+            out = std::copy(vals, vals + m, out);
+        }
+
+        *out++ = this->ending();
+        return out;
+    }
+
+    /// Number of polyline points of approximate_predicted
+    ///     Bernstein coefficients of s'' of degree M: b[j] = sum( C(j, i) / C(M, i) * c[i], i <= j ),
+    ///     s'' lies in their convex hull on [0, 1], so max|s''| <= max|b[j]|
+    TE size_type ME predict_approximation ( T accuracy ) const
+    {
+        const size_type M = Degree > 1 ? Degree - 2 : 0;
+        const T max_chords = T(size_type(1) << ApproximationDepth);
+
+        if ( Degree < 2 )
+            return 2;
+
+        U c[M + 1];
+        for ( size_type i = 0; i <= M; i++ )
+            c[i] = T((i + 2) * (i + 1)) * m_Coefs[i + 2];
+
+        T bound = 0;
+        for ( size_type j = 0; j <= M; j++ )
+        {
+            U b = c[0];
+            for ( size_type i = 1; i <= j; i++ )
+                b = b + (T(details::d_coef(j, i)) / T(details::d_coef(M, i))) * c[i];
+
+            bound = std::max(bound, T(details::norm_(b)));
+        }
+
+        const T n = ceil(sqrt(bound / (8 * accuracy)));
+        return (n < max_chords ? std::max(size_type(1), size_type(n)) : size_type(max_chords)) + 1;
+    }
+
+    /// Obtain values at uniform parameters, last value is exact segment ending
+    TE template < class OutPtIt > void ME sample_uniform ( size_type n, OutPtIt out, size_type reanchor ) const
+    {
+        n = std::max(size_type(1), n);
+
+        out = details::sample_uniform(*this, n, n, reanchor, out);
+        *out++ = this->ending();
+    }
+
+
+#undef TE
+#undef ME
+
+}
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+/// batch polynomial evaluation kernels
+/// Polynomial is evaluated by Horner scheme for many parameters at once.
+/// If value_type components are known (see value_traits.h) and parameter type is double,
+/// parameters are processed in SIMD lanes (AVX - 4 lanes, SSE2 - 2 lanes), otherwise scalar
+/// loop with value_type operators is used.
+///
+/// Define GSL_NO_SIMD to disable intrinsics.
+
+#pragma once
+
+#include <algorithm>
+
+#include "splines_aux.h"
+#include "value_traits.h"
+
+#if !defined(GSL_NO_SIMD)
+#   if defined(__AVX__)
+#       define GSL_SIMD_AVX
+#       define GSL_SIMD_SSE2
+#       include <immintrin.h>
+#   elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define GSL_SIMD_SSE2
+#       include <emmintrin.h>
+#   endif
+#endif
+
+namespace gsl
+{
+    namespace details
+    {
+        /// Components of value_type can be processed in double lanes
+        template < typename T, typename U >
+            struct is_vectorizable
+        {
+            static const bool value = is_same<T, double>::value && is_same<typename scalar_of<U>::type, double>::value;
+        };
+
+        // ----------------------------------------------------------------
+        /// Evaluate polynomial c[0] + c[1]*t + ... + c[N-1]*t^(N-1) at parameters ts[0..count)
+        /// Generic implementation, uses only value_type operators
+        template < typename T, typename U, size_type N, bool Vectorized = is_vectorizable<T, U>::value >
+            struct polynomial_evaluator
+        {
+            static void apply( const U * c, const T * ts, size_type count, U * out )
+            {
+                for ( size_type j = 0; j < count; j++ )
+                {
+                    U r = c[N - 1];
+                    for ( size_type i = N - 1; i > 0; i-- )
+                        r = ts[j] * r + c[i - 1];
+
+                    out[j] = r;
+                }
+            }
+        };
+
+        // ----------------------------------------------------------------
+        /// Evaluate polynomial with packed 2-component result in 4 AVX lanes, components are
+        /// interleaved in registers and stored directly. Return number of processed parameters
+        template < size_type N, size_type Dim >
+            struct packed_evaluator
+        {
+            static size_type apply( const double (*)[N], const double *, size_type, double * ) { return 0; }
+        };
+
+#if defined(GSL_SIMD_AVX)
+        template < size_type N >
+            struct packed_evaluator<N, 2>
+        {
+            static size_type apply( const double (*cc)[N], const double * ts, size_type count, double * out )
+            {
+                size_type j = 0;
+                for ( ; j + 4 <= count; j += 4 )
+                {
+                    const __m256d t = _mm256_loadu_pd(ts + j);
+                    __m256d x = _mm256_set1_pd(cc[0][N - 1]);
+                    __m256d y = _mm256_set1_pd(cc[1][N - 1]);
+                    for ( size_type i = N - 1; i > 0; i-- )
+                    {
+                        x = _mm256_add_pd(_mm256_mul_pd(x, t), _mm256_set1_pd(cc[0][i - 1]));
+                        y = _mm256_add_pd(_mm256_mul_pd(y, t), _mm256_set1_pd(cc[1][i - 1]));
+                    }
+
+                    const __m256d lo = _mm256_unpacklo_pd(x, y); // x0 y0 x2 y2
+                    const __m256d hi = _mm256_unpackhi_pd(x, y); // x1 y1 x3 y3
+                    _mm256_storeu_pd(out + 2 * j + 0, _mm256_permute2f128_pd(lo, hi, 0x20));
+                    _mm256_storeu_pd(out + 2 * j + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+                }
+
+                return j;
+            }
+        };
+#endif
+
+        // ----------------------------------------------------------------
+        /// Component-wise implementation, parameters are processed in SIMD lanes
+        ///     For every component Horner scheme runs over a block of parameters (lanes are innermost),
+        ///     then results are scattered to value_type
+        template < typename U, size_type N >
+            struct polynomial_evaluator<double, U, N, true>
+        {
+            typedef value_traits<U> traits;
+            static const size_type Dim = traits::dimension;
+            static const size_type BlockSize = 64;
+
+            static void apply( const U * c, const double * ts, size_type count, U * out )
+            {
+                double cc[Dim][N];
+                for ( size_type d = 0; d < Dim; d++ )
+                    for ( size_type i = 0; i < N; i++ )
+                        cc[d][i] = traits::get(c[i], d);
+
+                size_type b = 0;
+                if ( traits::packed )
+                    b = packed_evaluator<N, Dim>::apply(cc, ts, count, reinterpret_cast<double *>(out));
+
+                double r[BlockSize];
+
+                for ( ; b < count; b += BlockSize )
+                {
+                    const size_type n = std::min(size_type(BlockSize), count - b);
+                    const double * t = ts + b;
+
+                    for ( size_type d = 0; d < Dim; d++ )
+                    {
+                        horner(cc[d], t, n, r);
+
+                        if ( traits::packed )
+                        {
+                            double * o = reinterpret_cast<double *>(out + b) + d;
+                            for ( size_type j = 0; j < n; j++ )
+                                o[j * Dim] = r[j];
+                        }
+                        else
+                        {
+                            for ( size_type j = 0; j < n; j++ )
+                                traits::set(out[b + j], d, r[j]);
+                        }
+                    }
+                }
+            }
+
+        private:
+            static void horner( const double * c, const double * t, size_type n, double * r )
+            {
+                size_type j = 0;
+
+#if defined(GSL_SIMD_AVX)
+                for ( ; j + 4 <= n; j += 4 )
+                {
+                    const __m256d tt = _mm256_loadu_pd(t + j);
+                    __m256d rr = _mm256_set1_pd(c[N - 1]);
+                    for ( size_type i = N - 1; i > 0; i-- )
+                        rr = _mm256_add_pd(_mm256_mul_pd(rr, tt), _mm256_set1_pd(c[i - 1]));
+
+                    _mm256_storeu_pd(r + j, rr);
+                }
+#endif
+
+#if defined(GSL_SIMD_SSE2)
+                for ( ; j + 2 <= n; j += 2 )
+                {
+                    const __m128d tt = _mm_loadu_pd(t + j);
+                    __m128d rr = _mm_set1_pd(c[N - 1]);
+                    for ( size_type i = N - 1; i > 0; i-- )
+                        rr = _mm_add_pd(_mm_mul_pd(rr, tt), _mm_set1_pd(c[i - 1]));
+
+                    _mm_storeu_pd(r + j, rr);
+                }
+#endif
+
+                for ( ; j < n; j++ )
+                {
+                    double rr = c[N - 1];
+                    for ( size_type i = N - 1; i > 0; i-- )
+                        rr = rr * t[j] + c[i - 1];
+
+                    r[j] = rr;
+                }
+            }
+        };
+    }
+}
@@ -0,0 +1,419 @@
+///////////////////////////////////////////////////////////////////////////////
+/// small_vector: vector which keeps up to N elements inline (without allocations)
+/// inline_storage: storage selector for spline (it's used instead of allocator), e.g.
+///     spline<S, Policy, inline_storage<8> > keeps up to 8 segments inside the spline object,
+///     spline_builder keeps up to 8 control points inline too. Longer splines use allocator.
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <new>
+
+#include "allocator.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// Storage selector: N elements inline, Alloc (rebound to element type) for longer sequences
+    template < size_type N, class Alloc = std::allocator<char> >
+        struct inline_storage
+    {
+    };
+
+    // ----------------------------------------------------------------
+    /// small_vector class template
+    ///      Subset of std::vector interface used by splines. Iterators are pointers, they are invalidated
+    ///      by any modification which changes size (the same as for std::vector reallocation)
+    template < class T, size_type N, class Alloc = std::allocator<T> >
+        class small_vector
+    {
+    public:
+        //@{ Container types definition
+        typedef T value_type;
+        typedef Alloc allocator_type;
+        typedef gsl::size_type size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T & reference;
+        typedef const T & const_reference;
+        typedef T * pointer;
+        typedef const T * const_pointer;
+        typedef T * iterator;
+        typedef const T * const_iterator;
+        //@}
+
+    public:
+        explicit small_vector( const allocator_type & alloc = allocator_type() );
+
+        template < class InIt >
+            small_vector( InIt first, InIt last, const allocator_type & alloc = allocator_type() );
+
+        small_vector( const small_vector & rhs );
+        small_vector & operator= ( const small_vector & rhs );
+
+#if defined(GSL_CXX11)
+        /// Heap storage is moved, inline elements are copied
+        small_vector( small_vector && rhs );
+        small_vector & operator= ( small_vector && rhs );
+#endif
+
+        ~small_vector();
+
+        //@{ Access
+        iterator begin() { return m_Begin; }
+        iterator end() { return m_Begin + m_Size; }
+        const_iterator begin() const { return m_Begin; }
+        const_iterator end() const { return m_Begin + m_Size; }
+
+        reference operator[] ( size_type idx ) { return m_Begin[idx]; }
+        const_reference operator[] ( size_type idx ) const { return m_Begin[idx]; }
+        reference at( size_type idx );
+        const_reference at( size_type idx ) const;
+
+        reference front() { return m_Begin[0]; }
+        reference back() { return m_Begin[m_Size - 1]; }
+        const_reference front() const { return m_Begin[0]; }
+        const_reference back() const { return m_Begin[m_Size - 1]; }
+
+        size_type size() const { return m_Size; }
+        size_type capacity() const { return m_Capacity; }
+        bool empty() const { return m_Size == 0; }
+
+        /// Check elements are stored inline
+        bool is_inline() const { return m_Begin == this->inline_data(); }
+
+        allocator_type get_allocator() const { return m_Alloc; }
+        //@}
+
+        //@{ Modifiers
+        void reserve( size_type n );
+        void resize( size_type n, const value_type & val = value_type() );
+        void clear() { this->destroy(0, m_Size); m_Size = 0; }
+
+        void push_back( const value_type & val );
+        void pop_back() { this->destroy(m_Size - 1, m_Size); --m_Size; }
+
+        iterator insert( iterator where, const value_type & val );
+
+        template < class InIt >
+            void insert( iterator where, InIt first, InIt last );
+
+        iterator erase( iterator where ) { return this->erase(where, where + 1); }
+        iterator erase( iterator first, iterator last );
+
+        /// Swap elements (and allocators), heap storage is swapped without copying
+        void swap( small_vector & rhs );
+        //@}
+
+    private:
+        T * inline_data() { return reinterpret_cast<T *>(&m_Inline); }
+        const T * inline_data() const { return reinterpret_cast<const T *>(&m_Inline); }
+
+        /// Move elements to storage with at least 'n' capacity
+        void grow( size_type n );
+
+        void destroy( size_type from, size_type to );
+
+        void deallocate();
+
+    private:
+        /// Inline elements storage, alignment is the strictest of fundamental types
+        union inline_buffer
+        {
+            char data[N * sizeof(T)];
+            long double ld;
+            double d;
+            void * p;
+        };
+
+        allocator_type m_Alloc;
+        T * m_Begin;
+        size_type m_Size;
+        size_type m_Capacity;
+        inline_buffer m_Inline;
+    };
+
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Allocator type and container of elements T for spline storage selector A (allocator or inline_storage),
+        /// container of cached data of decorators and size of blocks of segments it's updated by (zero - single block)
+        template < class A, class T >
+            struct storage_traits
+        {
+            typedef typename rebind_alloc<A, T>::type allocator_type;
+            typedef std::vector<T, allocator_type> container_type;
+            typedef std::vector<T, allocator_type> cache_type;
+            static const size_type cache_block = 0;
+        };
+
+        template < size_type N, class A, class T >
+            struct storage_traits< inline_storage<N, A>, T >
+        {
+            typedef typename rebind_alloc<A, T>::type allocator_type;
+            typedef small_vector<T, N, allocator_type> container_type;
+            typedef std::vector<T, allocator_type> cache_type;
+            static const size_type cache_block = 0;
+        };
+    }
+
+    // ================================================================
+    // small_vector class template
+    // Implementation
+
+#define TE template < class T, size_type N, class Alloc >
+#define ME small_vector<T, N, Alloc>::
+
+    // ----------------------------------------------------------------
+    TE ME small_vector( const allocator_type & alloc )
+        : m_Alloc(alloc)
+        , m_Begin(this->inline_data())
+        , m_Size(0)
+        , m_Capacity(N)
+    {
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt > ME small_vector( InIt first, InIt last, const allocator_type & alloc )
+        : m_Alloc(alloc)
+        , m_Begin(this->inline_data())
+        , m_Size(0)
+        , m_Capacity(N)
+    {
+        this->insert(this->end(), first, last);
+    }
+
+    // ----------------------------------------------------------------
+    TE ME small_vector( const small_vector & rhs )
+        : m_Alloc(rhs.m_Alloc)
+        , m_Begin(this->inline_data())
+        , m_Size(0)
+        , m_Capacity(N)
+    {
+        this->reserve(rhs.size());
+        this->insert(this->end(), rhs.begin(), rhs.end());
+    }
+
+    // ----------------------------------------------------------------
+    TE small_vector<T, N, Alloc> & ME operator= ( const small_vector & rhs )
+    {
+        if ( this != &rhs )
+        {
+            this->clear();
+            this->reserve(rhs.size());
+            this->insert(this->end(), rhs.begin(), rhs.end());
+        }
+
+        return *this;
+    }
+
+#if defined(GSL_CXX11)
+    // ----------------------------------------------------------------
+    TE ME small_vector( small_vector && rhs )
+        : m_Alloc(rhs.m_Alloc)
+        , m_Begin(this->inline_data())
+        , m_Size(0)
+        , m_Capacity(N)
+    {
+        this->swap(rhs);
+    }
+
+    // ----------------------------------------------------------------
+    TE small_vector<T, N, Alloc> & ME operator= ( small_vector && rhs )
+    {
+        if ( this != &rhs )
+        {
+            if ( !rhs.is_inline() && m_Alloc == rhs.m_Alloc )
+            {
+                this->clear();
+                this->deallocate();
+                this->swap(rhs);
+            }
+            else
+            {
+                this->clear();
+                this->insert(this->end(), rhs.begin(), rhs.end());
+                rhs.clear();
+            }
+        }
+
+        return *this;
+    }
+#endif
+
+    // ----------------------------------------------------------------
+    TE ME ~small_vector()
+    {
+        this->clear();
+        this->deallocate();
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME reference ME at( size_type idx )
+    {
+        if ( idx >= m_Size )
+            throw std::out_of_range("small_vector::at");
+
+        return m_Begin[idx];
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME const_reference ME at( size_type idx ) const
+    {
+        if ( idx >= m_Size )
+            throw std::out_of_range("small_vector::at");
+
+        return m_Begin[idx];
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME reserve( size_type n )
+    {
+        if ( n > m_Capacity )
+            this->grow(n);
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME resize( size_type n, const value_type & val )
+    {
+        if ( n < m_Size )
+        {
+            this->destroy(n, m_Size);
+            m_Size = n;
+            return;
+        }
+
+        this->reserve(n);
+        std::uninitialized_fill(m_Begin + m_Size, m_Begin + n, val);
+        m_Size = n;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME push_back( const value_type & val )
+    {
+        if ( m_Size == m_Capacity )
+        {
+            // val could be an element of the vector
+            const value_type copy(val);
+            this->grow(2 * m_Capacity);
+            new (m_Begin + m_Size) value_type(copy);
+        }
+        else
+            new (m_Begin + m_Size) value_type(val);
+
+        ++m_Size;
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME iterator ME insert( iterator where, const value_type & val )
+    {
+        const size_type idx = where - m_Begin;
+        this->push_back(val);
+        std::rotate(m_Begin + idx, m_Begin + m_Size - 1, m_Begin + m_Size);
+        return m_Begin + idx;
+    }
+
+    // ----------------------------------------------------------------
+    /// Elements are appended and rotated to their place, so any input iterators are supported
+    TE template < class InIt > void ME insert( iterator where, InIt first, InIt last )
+    {
+        const size_type idx = where - m_Begin, size = m_Size;
+
+        for ( ; first != last; ++first )
+            this->push_back(*first);
+
+        std::rotate(m_Begin + idx, m_Begin + size, m_Begin + m_Size);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME iterator ME erase( iterator first, iterator last )
+    {
+        const iterator e = std::copy(last, this->end(), first);
+        const size_type n = e - m_Begin;
+        this->destroy(n, m_Size);
+        m_Size = n;
+        return first;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME swap( small_vector & rhs )
+    {
+        if ( !this->is_inline() && !rhs.is_inline() )
+        {
+            std::swap(m_Alloc, rhs.m_Alloc);
+            std::swap(m_Begin, rhs.m_Begin);
+            std::swap(m_Size, rhs.m_Size);
+            std::swap(m_Capacity, rhs.m_Capacity);
+            return;
+        }
+
+        // heap storage of one vector is given to the other one, inline elements are copied
+        small_vector & a = this->is_inline() ? *this : rhs;
+        small_vector & b = this->is_inline() ? rhs : *this;
+
+        small_vector copy(a);
+        a.clear();
+
+        if ( b.is_inline() )
+            a.insert(a.end(), b.begin(), b.end());
+        else
+        {
+            a.m_Begin = b.m_Begin;
+            a.m_Size = b.m_Size;
+            a.m_Capacity = b.m_Capacity;
+            b.m_Begin = b.inline_data();
+            b.m_Size = 0;
+            b.m_Capacity = N;
+        }
+
+        b.clear();
+        b.insert(b.end(), copy.begin(), copy.end());
+        std::swap(a.m_Alloc, b.m_Alloc);
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME grow( size_type n )
+    {
+        n = std::max(n, N + 1);
+
+        T * p = m_Alloc.allocate(n);
+        try
+        {
+            std::uninitialized_copy(m_Begin, m_Begin + m_Size, p);
+        }
+        catch ( ... )
+        {
+            m_Alloc.deallocate(p, n);
+            throw;
+        }
+
+        this->destroy(0, m_Size);
+        this->deallocate();
+
+        m_Begin = p;
+        m_Capacity = n;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME destroy( size_type from, size_type to )
+    {
+        for ( size_type i = from; i < to; i++ )
+            m_Begin[i].~T();
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME deallocate()
+    {
+        if ( !this->is_inline() )
+            m_Alloc.deallocate(m_Begin, m_Capacity);
+
+        m_Begin = this->inline_data();
+        m_Capacity = N;
+    }
+
+#undef TE
+#undef ME
+
+}
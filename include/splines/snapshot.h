@@ -0,0 +1,494 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Immutable spline snapshots for concurrent readers (requires C++11)
+///
+/// shared_storage<Chunk, Alloc>: storage selector for spline (it's used instead of allocator), segments
+///     are kept in reference counted chunks of up to 'Chunk' segments. Copy of spline shares all chunks,
+///     modification of segment copies its chunk only if the chunk is shared (copy on write). Insertion and
+///     removal repack only the chunks they touch, so chunks may be partially filled.
+///     Decorators keep per-segment cached data in the same chunks (see spline::cache), cumulative data
+///     (lengths, numbers of inverse pieces, boxes of aabb-tree) is relative to blocks of up to 'Chunk' segments.
+///
+/// snapshot_publisher<Spline>: one writer publishes versions of spline, any number of readers take the
+///     current version and use it without locks while writer continues editing, e.g.
+///         typedef spline_arclength< spline_localization< spline<S, Policy, shared_storage<64> > > > Spline;
+///         spline_builder<Spline, catmull_rom_spline> builder(first_pt, last_pt);  // writer's spline
+///         snapshot_publisher<Spline> publisher(builder);
+///         // writer thread                    // reader threads
+///         builder.change(i, pt);              publisher.current()->distance(pt, t);
+///         publisher.publish(builder);         publisher.current()->s2t(s);
+///     builder.change() and insert/remove copy the chunks of rebuilt segments only. Publication prepares
+///     caches of decorators for rebuilt segments only (see spline::changed_since): cached data of their
+///     blocks is written to copied chunks, block totals and the tree over blocks are updated. Then the copy
+///     shares all chunks and copies per-block arrays only, so publish() takes O(n / Chunk) plus O(Chunk)
+///     for every touched block. Readers access snapshot by const reference, so they never copy chunks.
+///
+/// Snapshot is prepared (see spline::prepare) before it's published and it's never modified, so its
+/// const methods are safe for concurrent use. Readers don't wait for writer: current() and publish()
+/// only exchange shared_ptr (std::atomic_load / std::atomic_store), snapshot is built before it.
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <atomic>
+
+#include "small_vector.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// Storage selector: segments in shared chunks of 'Chunk' elements, Alloc (rebound to element type)
+    template < size_type Chunk = 64, class Alloc = std::allocator<char> >
+        struct shared_storage
+    {
+    };
+
+    // ----------------------------------------------------------------
+    /// chunked_iterator class template
+    ///      Random access iterator of chunked_vector, Vec is const for const iterator.
+    ///      Dereference of non-const iterator makes the chunk unique (see chunked_vector::operator[])
+    template < class Vec, class T >
+        class chunked_iterator
+    {
+    public:
+        //@{ Iterator types definition
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename std::remove_const<T>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T * pointer;
+        typedef T & reference;
+        //@}
+
+    public:
+        chunked_iterator() : m_Vec(0), m_Idx(0) {}
+        chunked_iterator( Vec * vec, size_type idx ) : m_Vec(vec), m_Idx(idx) {}
+
+        /// Conversion of iterator to const_iterator
+        template < class V, class U >
+            chunked_iterator( const chunked_iterator<V, U> & rhs ) : m_Vec(rhs.container()), m_Idx(rhs.index()) {}
+
+        Vec * container() const { return m_Vec; }
+        size_type index() const { return m_Idx; }
+
+        reference operator* () const { return (*m_Vec)[m_Idx]; }
+        pointer operator-> () const { return &(*m_Vec)[m_Idx]; }
+        reference operator[] ( difference_type n ) const { return (*m_Vec)[m_Idx + n]; }
+
+        chunked_iterator & operator++ () { ++m_Idx; return *this; }
+        chunked_iterator & operator-- () { --m_Idx; return *this; }
+        chunked_iterator operator++ ( int ) { chunked_iterator tmp(*this); ++m_Idx; return tmp; }
+        chunked_iterator operator-- ( int ) { chunked_iterator tmp(*this); --m_Idx; return tmp; }
+
+        chunked_iterator & operator+= ( difference_type n ) { m_Idx += n; return *this; }
+        chunked_iterator & operator-= ( difference_type n ) { m_Idx -= n; return *this; }
+        chunked_iterator operator+ ( difference_type n ) const { return chunked_iterator(m_Vec, m_Idx + n); }
+        chunked_iterator operator- ( difference_type n ) const { return chunked_iterator(m_Vec, m_Idx - n); }
+        friend chunked_iterator operator+ ( difference_type n, const chunked_iterator & it ) { return it + n; }
+
+        difference_type operator- ( const chunked_iterator & rhs ) const { return difference_type(m_Idx) - difference_type(rhs.m_Idx); }
+
+        bool operator== ( const chunked_iterator & rhs ) const { return m_Idx == rhs.m_Idx; }
+        bool operator!= ( const chunked_iterator & rhs ) const { return m_Idx != rhs.m_Idx; }
+        bool operator< ( const chunked_iterator & rhs ) const { return m_Idx < rhs.m_Idx; }
+        bool operator> ( const chunked_iterator & rhs ) const { return m_Idx > rhs.m_Idx; }
+        bool operator<= ( const chunked_iterator & rhs ) const { return m_Idx <= rhs.m_Idx; }
+        bool operator>= ( const chunked_iterator & rhs ) const { return m_Idx >= rhs.m_Idx; }
+
+    private:
+        Vec * m_Vec;
+        size_type m_Idx;
+    };
+
+    // ----------------------------------------------------------------
+    /// chunked_vector class template
+    ///      Subset of std::vector interface used by splines. Elements are kept in shared_ptr chunks of
+    ///      Chunk / 2 to 'Chunk' elements (the last one may be shorter), copy of vector shares chunks.
+    ///      Non-const access copies the chunk if it's shared, const access never modifies chunks.
+    ///      Insertion and erasure repack (copy) the chunks which contain affected elements only,
+    ///      chunks after them are kept. References are invalidated by modifications of the chunk only
+    template < class T, size_type Chunk, class Alloc = std::allocator<T> >
+        class chunked_vector
+    {
+    public:
+        //@{ Container types definition
+        typedef T value_type;
+        typedef Alloc allocator_type;
+        typedef gsl::size_type size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T & reference;
+        typedef const T & const_reference;
+        typedef T * pointer;
+        typedef const T * const_pointer;
+        typedef chunked_iterator<chunked_vector, T> iterator;
+        typedef chunked_iterator<const chunked_vector, const T> const_iterator;
+        //@}
+
+        static const size_type chunk_size = Chunk;
+
+    public:
+        explicit chunked_vector( const allocator_type & alloc = allocator_type() )
+            : m_Alloc(alloc), m_Chunks(alloc), m_Starts(alloc), m_Size(0), m_Uniform(true) {}
+
+        template < class InIt >
+            chunked_vector( InIt first, InIt last, const allocator_type & alloc = allocator_type() );
+
+        /// Copy shares chunks
+        chunked_vector( const chunked_vector & rhs ) = default;
+        chunked_vector & operator= ( const chunked_vector & rhs ) = default;
+
+        chunked_vector( chunked_vector && rhs )
+            : m_Alloc(rhs.m_Alloc), m_Chunks(rhs.m_Alloc), m_Starts(rhs.m_Alloc), m_Size(0), m_Uniform(true) { this->swap(rhs); }
+        chunked_vector & operator= ( chunked_vector && rhs );
+
+        //@{ Access
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, m_Size); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_Size); }
+
+        /// Non-const access copies the chunk if it's shared
+        reference operator[] ( size_type idx ) { const size_type c = this->chunk_of(idx); return (*this->unique_chunk(c))[idx - m_Starts[c]]; }
+        const_reference operator[] ( size_type idx ) const { const size_type c = this->chunk_of(idx); return (*m_Chunks[c])[idx - m_Starts[c]]; }
+        reference at( size_type idx );
+        const_reference at( size_type idx ) const;
+
+        reference front() { return (*this)[0]; }
+        reference back() { return (*this)[m_Size - 1]; }
+        const_reference front() const { return (*this)[0]; }
+        const_reference back() const { return (*this)[m_Size - 1]; }
+
+        size_type size() const { return m_Size; }
+        bool empty() const { return m_Size == 0; }
+
+        /// Number of chunks and number of chunks shared with other vectors
+        size_type chunks() const { return m_Chunks.size(); }
+        size_type shared_chunks() const;
+
+        allocator_type get_allocator() const { return m_Alloc; }
+        //@}
+
+        //@{ Modifiers
+        void clear() { m_Chunks.clear(); m_Starts.clear(); m_Size = 0; m_Uniform = true; }
+
+        void push_back( const value_type & val );
+        void pop_back() { this->erase(this->end() - 1); }
+
+        iterator insert( iterator where, const value_type & val );
+        void insert( iterator where, size_type n, const value_type & val );
+
+        template < class InIt >
+            void insert( iterator where, InIt first, InIt last );
+
+        iterator erase( iterator where ) { return this->erase(where, where + 1); }
+        iterator erase( iterator first, iterator last );
+
+        void swap( chunked_vector & rhs );
+        //@}
+
+    private:
+        typedef std::vector<T, Alloc> chunk_type;
+        typedef std::shared_ptr<chunk_type> chunk_ptr;
+        typedef std::vector<chunk_ptr, typename details::rebind_alloc<Alloc, chunk_ptr>::type> chunks_type;
+        typedef std::vector<size_type, typename details::rebind_alloc<Alloc, size_type>::type> starts_type;
+
+        /// Chunk which contains element 'idx', all chunks except the last one are usually full
+        size_type chunk_of( size_type idx ) const
+        {
+            return m_Uniform ? idx / Chunk : size_type(std::upper_bound(m_Starts.begin() + 1, m_Starts.end(), idx) - m_Starts.begin()) - 1;
+        }
+
+        /// New chunk with capacity of 'Chunk' elements
+        chunk_ptr make_chunk() const;
+
+        /// Chunk 'c', copied if it's shared
+        chunk_type * unique_chunk( size_type c );
+
+        /// Replace elements [from, to) with 'count' elements from 'first'
+        template < class FwdIt >
+            void replace( size_type from, size_type to, FwdIt first, size_type count );
+
+    private:
+        allocator_type m_Alloc;
+        chunks_type m_Chunks;
+        starts_type m_Starts; ///< Index of the first element of every chunk
+        size_type m_Size;
+        bool m_Uniform; ///< Chunk 'c' starts with element c * Chunk
+    };
+
+    namespace details
+    {
+        template < size_type Chunk, class A, class T >
+            struct storage_traits< shared_storage<Chunk, A>, T >
+        {
+            typedef typename rebind_alloc<A, T>::type allocator_type;
+            typedef chunked_vector<T, Chunk, allocator_type> container_type;
+            typedef chunked_vector<T, Chunk, allocator_type> cache_type;
+            static const size_type cache_block = Chunk;
+        };
+    }
+
+    // ----------------------------------------------------------------
+    /// snapshot_publisher class template
+    ///      Keeps the current immutable version of Spline (any decorated spline, use shared_storage
+    ///      to share segments between versions). Publisher itself is safe for concurrent use
+    template < class Spline >
+        class snapshot_publisher
+    {
+    public:
+        typedef Spline spline_type;
+        typedef std::shared_ptr<const Spline> snapshot_type;
+
+    public:
+        /// Constructor. Current version is empty spline
+        snapshot_publisher() : m_Current(std::make_shared<const Spline>()) {}
+
+        /// Constructor. Current version is a copy of 'spline'
+        explicit snapshot_publisher( const Spline & spline ) { this->publish(spline); }
+
+        /// Current version, it's valid while returned pointer is kept
+        snapshot_type current() const { return std::atomic_load(&m_Current); }
+
+        /// Make a prepared copy of 'spline' the current version, previous version is released by its last reader.
+        /// 'spline' is prepared as well, call it from the thread which modifies 'spline'. Segments and cached
+        /// data of decorators are shared between versions, the copy takes O(n / Chunk) (see shared_storage)
+        snapshot_type publish( const Spline & spline );
+
+    private:
+        snapshot_publisher( const snapshot_publisher & );
+        snapshot_publisher & operator= ( const snapshot_publisher & );
+
+    private:
+        snapshot_type m_Current;
+    };
+
+    // ================================================================
+    // chunked_vector class template
+    // Implementation
+
+#define TE template < class T, size_type Chunk, class Alloc >
+#define ME chunked_vector<T, Chunk, Alloc>::
+
+    // ----------------------------------------------------------------
+    TE template < class InIt > ME chunked_vector( InIt first, InIt last, const allocator_type & alloc )
+        : m_Alloc(alloc)
+        , m_Chunks(alloc)
+        , m_Starts(alloc)
+        , m_Size(0)
+        , m_Uniform(true)
+    {
+        for ( ; first != last; ++first )
+            this->push_back(*first);
+    }
+
+    // ----------------------------------------------------------------
+    TE chunked_vector<T, Chunk, Alloc> & ME operator= ( chunked_vector && rhs )
+    {
+        if ( this != &rhs )
+        {
+            chunked_vector tmp(std::move(rhs));
+            this->swap(tmp);
+        }
+
+        return *this;
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME reference ME at( size_type idx )
+    {
+        if ( idx >= m_Size )
+            throw std::out_of_range("chunked_vector::at");
+
+        return (*this)[idx];
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME const_reference ME at( size_type idx ) const
+    {
+        if ( idx >= m_Size )
+            throw std::out_of_range("chunked_vector::at");
+
+        return (*this)[idx];
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME shared_chunks() const
+    {
+        size_type count = 0;
+        for ( size_type i = 0; i < m_Chunks.size(); i++ )
+            if ( m_Chunks[i].use_count() > 1 )
+                ++count;
+
+        return count;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME push_back( const value_type & val )
+    {
+        // chunks capacity is 'Chunk', so push_back doesn't move elements and 'val' stays valid
+        if ( m_Chunks.empty() || m_Chunks.back()->size() == Chunk )
+        {
+            chunk_ptr c = this->make_chunk();
+            c->push_back(val);
+            m_Chunks.push_back(c);
+            m_Starts.push_back(m_Size);
+        }
+        else
+            this->unique_chunk(m_Chunks.size() - 1)->push_back(val);
+
+        ++m_Size;
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME iterator ME insert( iterator where, const value_type & val )
+    {
+        const size_type idx = where.index();
+        this->replace(idx, idx, &val, 1);
+        return this->begin() + idx;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME insert( iterator where, size_type n, const value_type & val )
+    {
+        const chunk_type values(n, val, m_Alloc);
+        this->replace(where.index(), where.index(), values.begin(), n);
+    }
+
+    // ----------------------------------------------------------------
+    /// Elements are copied to temporary buffer, so any input iterators are supported
+    TE template < class InIt > void ME insert( iterator where, InIt first, InIt last )
+    {
+        const chunk_type values(first, last, m_Alloc);
+        this->replace(where.index(), where.index(), values.begin(), values.size());
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME iterator ME erase( iterator first, iterator last )
+    {
+        const size_type from = first.index();
+        this->replace(from, last.index(), static_cast<const T *>(0), 0);
+        return this->begin() + from;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME swap( chunked_vector & rhs )
+    {
+        std::swap(m_Alloc, rhs.m_Alloc);
+        m_Chunks.swap(rhs.m_Chunks);
+        m_Starts.swap(rhs.m_Starts);
+        std::swap(m_Size, rhs.m_Size);
+        std::swap(m_Uniform, rhs.m_Uniform);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME chunk_ptr ME make_chunk() const
+    {
+        chunk_ptr c = std::allocate_shared<chunk_type>(m_Alloc, m_Alloc);
+        c->reserve(Chunk);
+        return c;
+    }
+
+    // ----------------------------------------------------------------
+    /// Chunks are shared by copies of the vector only (snapshots), so use_count() == 1 can't be
+    /// changed by other threads. Greater count may be outdated, then the chunk is just copied.
+    /// use_count() is a relaxed load, acquire fence orders chunk modification after reads of the
+    /// chunk by the thread which released the last other reference
+    TE typename ME chunk_type * ME unique_chunk( size_type c )
+    {
+        chunk_ptr & p = m_Chunks[c];
+        if ( p.use_count() > 1 )
+        {
+            chunk_ptr copy = this->make_chunk();
+            copy->assign(p->begin(), p->end());
+            p = copy;
+        }
+        else
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        return p.get();
+    }
+
+    // ----------------------------------------------------------------
+    /// Chunks which contain elements [from, to) (or insertion point) are repacked with new elements to new
+    /// chunks, the next chunk is added if they would be shorter than Chunk / 2. Repacked chunks at the end
+    /// are filled up, so appending keeps chunks full, other ones get equal sizes
+    TE template < class FwdIt > void ME replace( size_type from, size_type to, FwdIt first, size_type count )
+    {
+        if ( from == to && count == 0 )
+            return;
+
+        size_type c0 = 0, c1 = 0;
+        if ( !m_Chunks.empty() )
+        {
+            c0 = this->chunk_of(std::min(from, m_Size - 1));
+            c1 = (to > from ? this->chunk_of(to - 1) : c0) + 1;
+        }
+
+        const size_type begin = c0 < m_Chunks.size() ? m_Starts[c0] : m_Size;
+        size_type end = c1 < m_Chunks.size() ? m_Starts[c1] : m_Size;
+        size_type k = end - begin - (to - from) + count;
+
+        if ( k > 0 && k < Chunk / 2 && c1 < m_Chunks.size() )
+        {
+            k += m_Chunks[c1]->size();
+            end += m_Chunks[c1++]->size();
+        }
+
+        // elements are read from old chunks, which are released after repacking
+        const chunked_vector & self = *this;
+        const size_type m = (k + Chunk - 1) / Chunk;
+        chunks_type chunks(m_Alloc);
+        chunks.reserve(m);
+
+        for ( size_type i = 0, j = 0; i < m; i++ )
+        {
+            const size_type size = end == m_Size ? std::min(Chunk, k - i * Chunk) : k / m + (i < k % m ? 1 : 0);
+
+            chunk_ptr c = this->make_chunk();
+            for ( size_type e = j + size; j < e; j++ )
+            {
+                if ( j < from - begin )
+                    c->push_back(self[begin + j]);
+                else if ( j < from - begin + count )
+                    c->push_back(*first++);
+                else
+                    c->push_back(self[to + j - (from - begin) - count]);
+            }
+
+            chunks.push_back(c);
+        }
+
+        m_Chunks.erase(m_Chunks.begin() + c0, m_Chunks.begin() + c1);
+        m_Chunks.insert(m_Chunks.begin() + c0, chunks.begin(), chunks.end());
+        m_Size = m_Size - (to - from) + count;
+
+        m_Starts.resize(m_Chunks.size());
+        for ( size_type c = c0; c < m_Chunks.size(); c++ )
+            m_Starts[c] = c > 0 ? m_Starts[c - 1] + m_Chunks[c - 1]->size() : 0;
+
+        m_Uniform = true;
+        for ( size_type c = 0; c < m_Chunks.size() && m_Uniform; c++ )
+            m_Uniform = m_Starts[c] == c * Chunk;
+    }
+
+#undef TE
+#undef ME
+
+    // ================================================================
+    // snapshot_publisher class template
+    // Implementation
+
+    // ----------------------------------------------------------------
+    template < class Spline > typename snapshot_publisher<Spline>::snapshot_type snapshot_publisher<Spline>::publish( const Spline & spline )
+    {
+        // caches are built in writer's spline and copied with segments, snapshot is never modified
+        spline.prepare();
+
+        const snapshot_type snapshot = std::make_shared<const Spline>(spline);
+        std::atomic_store(&m_Current, snapshot);
+        return snapshot;
+    }
+}
@@ -0,0 +1,452 @@
+///////////////////////////////////////////////////////////////////////////////
+/// soa_spline class template definition
+/// Read-only spline with structure-of-arrays coefficients storage: component 'c' of coefficient 'i'
+/// of all segments is stored in its own 64-byte aligned contiguous array.
+/// Queries over many segments (evaluate_segments, distance) run over these arrays in SIMD lanes,
+/// single parameter queries assemble segment from arrays and delegate to it.
+///
+/// value_traits<U> specialization is required (see value_traits.h).
+
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <limits>
+
+#include "segment.h"
+#include "spline.h"
+#include "value_traits.h"
+
+namespace gsl
+{
+    namespace details
+    {
+        // ----------------------------------------------------------------
+        /// Zero-initialized buffer of 'n' elements with 'Align' bytes aligned data
+        template < typename T, size_type Align >
+            class aligned_buffer
+        {
+        public:
+            aligned_buffer() : m_Raw(0), m_Data(0), m_Size(0) {}
+            explicit aligned_buffer( size_type n ) : m_Raw(0), m_Data(0), m_Size(0) { allocate(n); }
+            aligned_buffer( const aligned_buffer & rhs ) : m_Raw(0), m_Data(0), m_Size(0)
+            {
+                allocate(rhs.m_Size);
+                std::copy(rhs.m_Data, rhs.m_Data + m_Size, m_Data);
+            }
+            ~aligned_buffer() { std::free(m_Raw); }
+
+            aligned_buffer & operator= ( aligned_buffer rhs ) { swap(rhs); return *this; }
+
+            void swap( aligned_buffer & rhs )
+            {
+                std::swap(m_Raw, rhs.m_Raw);
+                std::swap(m_Data, rhs.m_Data);
+                std::swap(m_Size, rhs.m_Size);
+            }
+
+            T * data() { return m_Data; }
+            const T * data() const { return m_Data; }
+            size_type size() const { return m_Size; }
+
+        private:
+            void allocate( size_type n )
+            {
+                if ( n == 0 )
+                    return;
+
+                m_Raw = std::malloc(n * sizeof(T) + Align);
+                if ( !m_Raw )
+                    throw std::bad_alloc();
+
+                const size_t addr = reinterpret_cast<size_t>(m_Raw);
+                m_Data = reinterpret_cast<T *>((addr + Align - 1) / Align * Align);
+                m_Size = n;
+                std::fill_n(m_Data, n, T());
+            }
+
+        private:
+            void * m_Raw;
+            T * m_Data;
+            size_type m_Size;
+        };
+
+        // ----------------------------------------------------------------
+        /// Evaluate polynomials of 'n' segments at the same parameter, c[i] - array of i-th coefficients
+        /// c[i] should be 'Align' aligned and padded to multiple of 4 items
+        template < typename T, size_type N >
+            struct soa_evaluator
+        {
+            static void apply( const T * const * c, T t, size_type n, T * out )
+            {
+                for ( size_type j = 0; j < n; j++ )
+                {
+                    T r = c[N - 1][j];
+                    for ( size_type i = N - 1; i > 0; i-- )
+                        r = r * t + c[i - 1][j];
+
+                    out[j] = r;
+                }
+            }
+        };
+
+#if defined(GSL_SIMD_AVX)
+        template < size_type N >
+            struct soa_evaluator<double, N>
+        {
+            static void apply( const double * const * c, double t, size_type n, double * out )
+            {
+                const __m256d tt = _mm256_set1_pd(t);
+                for ( size_type j = 0; j < n; j += 4 )
+                {
+                    __m256d r = _mm256_load_pd(c[N - 1] + j);
+                    for ( size_type i = N - 1; i > 0; i-- )
+                        r = _mm256_add_pd(_mm256_mul_pd(r, tt), _mm256_load_pd(c[i - 1] + j));
+
+                    _mm256_storeu_pd(out + j, r);
+                }
+            }
+        };
+#endif
+    }
+
+    // ----------------------------------------------------------------
+    /// soa_spline class template
+    ///      Contains N segments of degree D
+    ///      Performs interpolation in range [0, N], parameter out of range will be truncated
+    template < typename T, typename U, size_type D >
+        class soa_spline
+    {
+    public:
+        static const size_type Degree = D;
+        static const size_type Dimension = value_traits<U>::dimension;
+        static const size_type Alignment = 64; ///< Alignment of coefficients arrays in bytes
+
+        //@{ common types definition
+        typedef segment<T, U, D> segment_type;
+
+        typedef T parameter_type;
+        typedef U value_type;
+        //@}
+
+    public:
+        /// Default constructor
+        soa_spline () : m_Size(0), m_Stride(0) {}
+
+        /// Construct from any spline (or other container of segments with coefficients() method)
+        template < class Spline >
+            explicit soa_spline ( const Spline & rhs );
+
+        /// Generic assignment operator
+        template < class Spline >
+            soa_spline & operator= ( const Spline & rhs )
+        {
+            return *this = soa_spline(rhs);
+        }
+
+        /// Number of spline segments
+        size_type size () const { return m_Size; }
+
+        /// Check spline is empty
+        bool empty () const { return m_Size == 0; }
+
+        /// Assemble segment with specified index
+        segment_type operator[] ( size_type idx ) const;
+
+        /// Array of component 'c' of coefficient 'i' of all segments (aligned, padded with zeros)
+        const parameter_type * coefficients ( size_type i, size_type c ) const { return m_Data.data() + (i * Dimension + c) * m_Stride; }
+
+        /// Obtain interpolated value
+        value_type operator() ( parameter_type t ) const;
+
+        /// Obtain 'K' derivative value
+        template < size_type K >
+            value_type derivative ( parameter_type t ) const;
+
+        /// Obtain value and derivatives 1..K in a single pass
+        template < size_type K >
+            segment_jet<parameter_type, value_type, K> evaluate_jet ( parameter_type t ) const;
+
+        /// Obtain interpolated values for parameters [first, last)
+        template < class InIt, class OutIt >
+            OutIt evaluate ( InIt first, InIt last, OutIt out ) const;
+
+        /// Obtain 'K' derivative values for parameters [first, last)
+        template < size_type K, class InIt, class OutIt >
+            OutIt derivative ( InIt first, InIt last, OutIt out ) const;
+
+        /// Obtain values of all segments at the same segment parameter 't' (segments are processed in SIMD lanes)
+        template < class OutIt >
+            OutIt evaluate_segments ( parameter_type t, OutIt out ) const;
+
+        /// Approximate distance from point to spline: minimum over 'samples' + 1 uniform samples of every segment
+        /// Samples of all segments are scanned in SIMD lanes
+        parameter_type distance ( value_type p, parameter_type * t, size_type samples ) const;
+
+        /// Approximate spline with polyline
+        template < class OutPtIt >
+            OutPtIt approximate ( parameter_type accuracy, OutPtIt out ) const;
+
+        /// Obtain curvature
+        parameter_type curvature( parameter_type t ) const;
+
+        /// Obtain curvature radius
+        parameter_type radius( parameter_type t ) const;
+
+        /// Obtain direction
+        value_type direction( parameter_type t ) const;
+
+        /// Obtain normal
+        value_type normal( parameter_type t ) const;
+
+    protected:
+        size_type parameter2idx( parameter_type & t ) const;
+
+    private:
+        static const size_type BlockSize = 64;
+
+        details::aligned_buffer<parameter_type, Alignment> m_Data;
+        size_type m_Size;
+        size_type m_Stride; ///< Capacity of every coefficient component array
+    };
+
+    // ================================================================
+    // soa_spline class template
+    // Implementation
+
+#define TE template < typename T, typename U, size_type D >
+#define ME soa_spline<T, U, D>::
+
+    // ----------------------------------------------------------------
+    TE template < class Spline > ME soa_spline ( const Spline & rhs )
+        : m_Size(rhs.size())
+    {
+        const size_type lanes = Alignment / sizeof(T);
+        m_Stride = (m_Size + lanes - 1) / lanes * lanes;
+
+        details::aligned_buffer<T, Alignment>((Degree + 1) * Dimension * m_Stride).swap(m_Data);
+
+        for ( size_type s = 0; s < m_Size; s++ )
+        {
+            const U * coefs = rhs[s].coefficients();
+            for ( size_type i = 0; i <= Degree; i++ )
+                for ( size_type c = 0; c < Dimension; c++ )
+                    m_Data.data()[(i * Dimension + c) * m_Stride + s] = value_traits<U>::get(coefs[i], c);
+        }
+    }
+
+    // ----------------------------------------------------------------
+    TE typename ME segment_type ME operator[] ( size_type idx ) const
+    {
+        U coefs[Degree + 1];
+        for ( size_type i = 0; i <= Degree; i++ )
+            for ( size_type c = 0; c < Dimension; c++ )
+                value_traits<U>::set(coefs[i], c, this->coefficients(i, c)[idx]);
+
+        return segment_type(coefs, coefs + Degree + 1);
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME operator() ( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i](t);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < size_type K > U ME derivative ( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i].template derivative<K>(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < size_type K > segment_jet<T, U, K> ME evaluate_jet ( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i].template evaluate_jet<K>(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt, class OutIt > OutIt ME evaluate ( InIt first, InIt last, OutIt out ) const
+    {
+        return this->template derivative<0>(first, last, out);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < size_type K, class InIt, class OutIt > OutIt ME derivative ( InIt first, InIt last, OutIt out ) const
+    {
+        parameter_type ts[BlockSize];
+        size_type idx[BlockSize];
+        value_type vals[BlockSize];
+
+        while ( first != last )
+        {
+            size_type n = 0;
+            for ( ; n < BlockSize && first != last; ++n, ++first )
+            {
+                ts[n] = *first;
+                idx[n] = this->parameter2idx(ts[n]);
+            }
+
+            for ( size_type b = 0, e = 0; b < n; b = e )
+            {
+                for ( e = b + 1; e < n && idx[e] == idx[b]; e++ ) {}
+                (*this)[idx[b]].template derivative<K>(ts + b, ts + e, vals + b);
+            }
+
+            out = std::copy(vals, vals + n, out);
+        }
+
+        return out;
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class OutIt > OutIt ME evaluate_segments ( parameter_type t, OutIt out ) const
+    {
+        T r[Dimension][BlockSize];
+        const T * c[Degree + 1];
+
+        for ( size_type b = 0; b < m_Size; b += BlockSize )
+        {
+            const size_type n = std::min(size_type(BlockSize), m_Size - b);
+
+            for ( size_type d = 0; d < Dimension; d++ )
+            {
+                for ( size_type i = 0; i <= Degree; i++ )
+                    c[i] = this->coefficients(i, d) + b;
+
+                details::soa_evaluator<T, Degree + 1>::apply(c, t, n, r[d]);
+            }
+
+            for ( size_type j = 0; j < n; j++ )
+            {
+                U v;
+                for ( size_type d = 0; d < Dimension; d++ )
+                    value_traits<U>::set(v, d, r[d][j]);
+
+                *out++ = v;
+            }
+        }
+
+        return out;
+    }
+
+    // ----------------------------------------------------------------
+    TE T ME distance ( value_type p, parameter_type * t, size_type samples ) const
+    {
+        if ( m_Size == 0 )
+            throw spline_empty_exception("");
+
+        samples = std::max(size_type(1), samples);
+
+        T v[BlockSize], d2[BlockSize];
+        const T * c[Degree + 1];
+
+        T best = std::numeric_limits<T>::max();
+        T best_t = 0;
+
+        for ( size_type b = 0; b < m_Size; b += BlockSize )
+        {
+            const size_type n = std::min(size_type(BlockSize), m_Size - b);
+
+            for ( size_type k = 0; k <= samples; k++ )
+            {
+                const T tk = T(k) / samples;
+
+                std::fill_n(d2, n, T());
+                for ( size_type d = 0; d < Dimension; d++ )
+                {
+                    for ( size_type i = 0; i <= Degree; i++ )
+                        c[i] = this->coefficients(i, d) + b;
+
+                    details::soa_evaluator<T, Degree + 1>::apply(c, tk, n, v);
+
+                    const T pd = value_traits<U>::get(p, d);
+                    for ( size_type j = 0; j < n; j++ )
+                        d2[j] += (v[j] - pd) * (v[j] - pd);
+                }
+
+                for ( size_type j = 0; j < n; j++ )
+                {
+                    if ( d2[j] < best )
+                    {
+                        best = d2[j];
+                        best_t = (b + j) + tk;
+                    }
+                }
+            }
+        }
+
+        if ( t )
+            *t = best_t;
+
+        return sqrt(best);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class OutPtIt > OutPtIt ME approximate ( parameter_type accuracy, OutPtIt out ) const
+    {
+        for ( size_type i = 0; i < m_Size; i++ )
+            out = (*this)[i].approximate(accuracy, out);
+
+        return out;
+    }
+
+    // ----------------------------------------------------------------
+    TE T ME curvature( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i].curvature(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE T ME radius( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i].radius(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME direction( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i].direction(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE U ME normal( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return (*this)[i].normal(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME parameter2idx( parameter_type & t ) const
+    {
+        if ( m_Size == 0 )
+            throw spline_empty_exception("");
+
+        if ( t <= 0 )
+        {
+            t = 0;
+            return 0;
+        }
+
+        if ( t >= m_Size )
+        {
+            t = 1;
+            return m_Size - 1;
+        }
+
+        size_type i = size_type(t);
+        t -= i;
+
+        return i;
+    }
+
+#undef TE
+#undef ME
+
+}
@@ -1,302 +1,720 @@
-///////////////////////////////////////////////////////////////////////////////
-/// spline class template definition
-
-#pragma once
-
-#include <vector>
-#include <string>
-
-#include "segment.h"
-
-namespace gsl
-{
-    // ----------------------------------------------------------------
-    /// This struct check are values equal or not
-    template < typename U >
-        struct segments_connected_verification_traits
-    {
-        static bool eq( U a, U b ) { return a == b; }
-    };
-
-    // ----------------------------------------------------------------
-    /// This exception will be thrown if spline invariant breaked
-    class spline_segments_disconnected_exception : public exception
-    {
-    public:
-        explicit spline_segments_disconnected_exception( const std::string & msg ) : exception(msg) {}
-    };
-
-    class spline_empty_exception : public exception
-    {
-    public:
-      explicit spline_empty_exception( const std::string & msg ) : exception(msg) {}
-    };
-
-    // ----------------------------------------------------------------
-    /// spline class template
-    ///      Contains N segments
-    ///      Performs interpolation in range [0, N]
-    ///      If parameter is out of range value will be truncated.
-    ///
-    /// Class invariant: s[i+1](1) == s[i](0);
-    /// If modifiers will try to break invariant then 'spline_segments_disconnected_exception' will be thrown
-    template < typename S, class SCVT = segments_connected_verification_traits<typename S::value_type> >
-        class spline
-    {
-    public:
-        /// Apply metafunction provide the ability to obtain spline with other other segment type
-        /// It's required to use decorated segments in spline decorators
-        template < typename OtherS > struct apply
-        {
-            typedef spline<OtherS, SCVT> type;
-        };
-
-    public:
-        static const size_type Degree = S::Degree;
-
-        //@{ common types definition
-        typedef SCVT segments_connected_verification_traits;
-        typedef S segment_type;
-
-        typedef typename segment_type::parameter_type parameter_type;
-        typedef typename segment_type::value_type value_type;
-
-        typedef typename std::vector<segment_type>::const_iterator const_iterator;
-        typedef typename std::vector<segment_type>::const_reference const_reference;
-        //@}
-
-    public:
-        /// Default constructor
-        spline () {}
-
-        /// Generic copy constructor
-        template < class OtherS >
-            spline ( const OtherS & rhs )
-        {
-            assign(rhs.begin(), rhs.end());
-        }
-
-        /// Generic assignment operator
-        template < class OtherS >
-            spline & operator= ( const OtherS & rhs )
-        {
-            return *this = spline(rhs); 
-        }
-
-        /// Constructor by segments
-        template < typename InIt >
-            spline ( InIt first, InIt last );
-
-        /// Obtain interpolated value
-        value_type operator() ( parameter_type t ) const;
-
-        /// Obtain 'K' derivative value
-        template < size_type K >
-            value_type derivative ( parameter_type t ) const;
-
-        /// Number of spline segments
-        size_type size () const { return m_Segs.size(); }
-
-        /// Check spline is empty
-        bool empty () const { return m_Segs.empty(); }
-        
-        /// Access to the segment with specified index
-        const_reference operator[] ( size_type idx ) const { return m_Segs[idx]; }
-
-        /// Checked access to the segment with specified index
-        const_reference at ( size_type idx ) const { return m_Segs.at(idx); }
-
-        /// Iterator which points to the first segment
-        const_iterator begin () const { return m_Segs.begin(); }
-
-        /// Iterator which points to the element after last
-        const_iterator end () const { return m_Segs.end(); }
-
-        /// Remove segments from 'from' to 'to' and insert segments [first, last) instead
-        template < class InIt >
-            void replace ( size_type from, size_type to, InIt first, InIt last );
-
-        /// Replace all existing segments with specified [first, last) segments
-        template < typename InIt >
-            void assign ( InIt first, InIt last );
-
-        /// Swap two splines
-        void swap ( spline & rhs ) { m_Segs.swap(rhs.m_Segs); }
-        
-        /// Clear spline
-        void clear () { m_Segs.clear(); }
-
-        /// Approximate spline with polyline
-        template < class OutPtIt >
-            void approximate ( parameter_type accuracy, OutPtIt out ) const;
-
-        /// Obtain curvature
-        parameter_type curvature( parameter_type t ) const;
-
-        /// Obtain curvature radius
-        parameter_type radius( parameter_type t ) const;
-
-        /// Obtain torsion
-        parameter_type torsion( parameter_type t ) const;
-
-        /// Obtain torsion radius
-        parameter_type torsion_radius( parameter_type t ) const;
-
-        /// Obtain direction
-        value_type direction( parameter_type t ) const;
-
-        /// Obtain normal
-        value_type normal( parameter_type t ) const;
-
-        /// Obtain binormal
-        value_type binormal( parameter_type t ) const;
-
-    protected:
-        void verify() const;
-        size_type parameter2idx( parameter_type & t ) const;
-
-    private:
-        std::vector<segment_type> m_Segs;
-    };
-
-    // ================================================================
-    // spline class template
-    // Implementation
-
-#define TE template < typename S, class SCVT >
-#define ME spline<S, SCVT>::
-
-    // ----------------------------------------------------------------
-    TE typename S::value_type ME operator() ( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i](t);
-    }
-
-    // ----------------------------------------------------------------
-    TE template < size_type Deg > typename S::value_type ME derivative ( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].derivative<Deg>(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE template < class InIt > ME spline ( InIt first, InIt last )
-        : m_Segs(first, last)
-    {
-        this->verify();
-    }
-
-    // ----------------------------------------------------------------
-    TE template < class InIt > void ME replace ( size_type from, size_type to, InIt first, InIt last )
-    {
-        typename std::vector<segment_type>::iterator it = m_Segs.erase(m_Segs.begin() + from, m_Segs.begin() + to);
-        m_Segs.insert(it, first, last);
-
-        // TODO: verify(from, to) method
-        this->verify();
-    }
-
-    // ----------------------------------------------------------------
-    TE template < class InIt > void ME assign ( InIt first, InIt last )
-    {
-        spline tmp(first, last);
-        tmp.swap(*this);
-    }
-
-    // ----------------------------------------------------------------
-    TE template < class OutPtIt > void ME approximate ( parameter_type accuracy, OutPtIt out ) const
-    {
-      for ( size_type i = 0; i < m_Segs.size(); i++ )
-        m_Segs[i].approximate(accuracy, out);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::parameter_type ME curvature( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].curvature(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::parameter_type ME radius( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].radius(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::parameter_type ME torsion( parameter_type t ) const
-    {
-        if ( m_Segs.empty() )
-            return parameter_type(); // TODO: throw exception ?
-
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].torsion(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::parameter_type ME torsion_radius( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].torsion_radius(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::value_type ME direction( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].direction(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::value_type ME normal( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].normal(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE typename S::value_type ME binormal( parameter_type t ) const
-    {
-        size_type i = this->parameter2idx(t);
-        return m_Segs[i].binormal(t);
-    }
-
-    // ----------------------------------------------------------------
-    TE void ME verify() const
-    {
-      for ( size_type i = 0; i + 1 < m_Segs.size(); i++ )
-          if ( !SCVT::eq(m_Segs[i](1), m_Segs[i + 1](0)) )
-              throw spline_segments_disconnected_exception("");
-    }
-
-    // ----------------------------------------------------------------
-    TE size_type ME parameter2idx( parameter_type & t ) const
-    {
-        if ( m_Segs.empty() )
-            throw spline_empty_exception("");
-
-        if ( t <= 0 )
-        {
-            t = 0;
-            return 0;
-        }
-        
-        if ( t >= m_Segs.size() )
-        {
-            t = 1;
-            return m_Segs.size() - 1;
-        }
-
-        size_type i = size_type(t);
-        t -= i;
-
-        /// @todo think about extrapolation behavior customization with traits - clip, cycle, ...
-        return std::max(size_type(0), std::min(size_type(m_Segs.size()), i));
-    }
-
-#undef TE
-#undef ME
-
-}
+///////////////////////////////////////////////////////////////////////////////
+/// spline class template definition
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "segment.h"
+#include "small_vector.h"
+
+#if defined(GSL_CXX11)
+#   include <atomic>
+#endif
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// This struct check are values equal or not
+    template < typename U >
+        struct segments_connected_verification_traits
+    {
+        static bool eq( U a, U b ) { return a == b; }
+    };
+
+    // ----------------------------------------------------------------
+    /// Joints verification on spline modification: none, only joints of modified segments, all joints
+    enum verify_strategy { verify_off, verify_ranged, verify_full };
+
+    /// Mapping of parameters out of [0, N]: clip to the ends, cycle (t mod N), extrapolate the end segments
+    enum extrapolation_strategy { extrapolation_clip, extrapolation_cycle, extrapolation_extrapolate };
+
+    // ----------------------------------------------------------------
+    /// Spline policy, it's the second template parameter of spline
+    ///     EqTraits::eq(a, b) checks that segments are connected
+    ///     Checked = false: parameters mapping doesn't check that spline isn't empty and doesn't throw
+    /// Traits without policy (e.g. segments_connected_verification_traits) are used as spline_policy<Traits>
+    template < class EqTraits
+             , verify_strategy Verify = verify_ranged
+             , bool Checked = true
+             , extrapolation_strategy Extrapolation = extrapolation_clip
+             >
+        struct spline_policy : EqTraits
+    {
+        typedef EqTraits eq_traits;
+
+        static const verify_strategy verification = Verify;
+        static const bool checked = Checked;
+        static const extrapolation_strategy extrapolation = Extrapolation;
+    };
+
+    namespace details
+    {
+        template < class T > struct void_type { typedef void type; };
+
+        /// Spline policy for the spline template parameter
+        template < class P, class Enable = void > struct spline_policy_of { typedef spline_policy<P> type; };
+        template < class P > struct spline_policy_of<P, typename void_type<typename P::eq_traits>::type> { typedef P type; };
+
+        /// Next value of the global revisions counter (0 is the revision of default constructed splines)
+        /// C++03: splines of different threads should be modified under external synchronization
+        inline size_type next_revision()
+        {
+#if defined(GSL_CXX11)
+            static std::atomic<size_type> counter(0);
+#else
+            static size_type counter = 0;
+#endif
+            return ++counter;
+        }
+
+        // ----------------------------------------------------------------
+        /// Last modifications of spline: record 'k' replaced segments of revision records[k].revision
+        /// except 'head' first and 'tail' last ones, the next record starts with the resulting revision
+        struct change_log
+        {
+            static const size_type Capacity = 4;
+
+            struct record
+            {
+                size_type revision, head, tail;
+            };
+
+            change_log() : records(), count(0) {}
+
+            /// Append record, the oldest one is dropped if log is full
+            void push( size_type revision, size_type head, size_type tail )
+            {
+                if ( count == Capacity )
+                    std::copy(records + 1, records + Capacity, records);
+                else
+                    count++;
+
+                const record r = { revision, head, tail };
+                records[count - 1] = r;
+            }
+
+            /// Obtain numbers of unchanged first and last segments since revision, false if it isn't logged
+            bool find( size_type revision, size_type * head, size_type * tail ) const
+            {
+                size_type k = 0;
+                while ( k < count && records[k].revision != revision )
+                    k++;
+
+                if ( k == count )
+                    return false;
+
+                *head = records[k].head;
+                *tail = records[k].tail;
+                for ( ; k < count; k++ )
+                {
+                    *head = std::min(*head, records[k].head);
+                    *tail = std::min(*tail, records[k].tail);
+                }
+
+                return true;
+            }
+
+            void clear() { count = 0; }
+
+            record records[Capacity];
+            size_type count;
+        };
+
+        // ----------------------------------------------------------------
+        /// Partition of segments to blocks of consecutive segments. Decorators keep cached data of segments
+        /// relative to their blocks (e.g. arc-length from the block beginning), so replacement of segments
+        /// changes data of their blocks only, data of other blocks is shared by copies of spline (see snapshot.h).
+        /// Blocks have from limit / 2 to 'limit' segments (the last one can be shorter), zero limit means
+        /// a single block
+        template < class A >
+            struct segment_blocks
+        {
+            typedef std::vector<size_type, typename rebind_alloc<A, size_type>::type> starts_type;
+
+            explicit segment_blocks( const A & alloc = A() ) : starts(alloc) {}
+
+            /// Number of blocks
+            size_type size() const { return starts.empty() ? 0 : starts.size() - 1; }
+
+            //@{ First segment of block 'b' and segment after it
+            size_type begin( size_type b ) const { return starts[b]; }
+            size_type end( size_type b ) const { return starts[b + 1]; }
+            //@}
+
+            /// Block which contains segment 'idx' (the last block for segments after it)
+            size_type find( size_type idx ) const
+            {
+                return size_type(std::upper_bound(starts.begin() + 1, starts.end() - 1, idx) - starts.begin()) - 1;
+            }
+
+            /// No segments, allocator is adopted from spline
+            template < class Al >
+                void reset( const Al & alloc )
+            {
+                adopt_allocator(starts, alloc);
+                starts.push_back(0);
+            }
+
+            /// Obtain blocks [*first, *last) which contain segments [from, to) to be replaced with 'count' segments
+            /// (the block of insertion point if there are no such segments). The next block is added if they would
+            /// be shorter than limit / 2
+            void affected( size_type from, size_type to, size_type count, size_type limit, size_type * first, size_type * last ) const
+            {
+                *first = *last = 0;
+                if ( this->size() == 0 )
+                    return;
+
+                *first = this->find(std::min(from, starts.back() - 1));
+                *last = (to > from ? this->find(to - 1) : *first) + 1;
+
+                const size_type k = starts[*last] - starts[*first] - (to - from) + count;
+                if ( k > 0 && k < limit / 2 && *last < this->size() )
+                    ++*last;
+            }
+
+            /// Split 'count' segments which replace segments of blocks [first, last) to new blocks, blocks after
+            /// them are shifted. Blocks at the end are filled up, other ones get equal sizes. Return block after new ones
+            size_type split( size_type first, size_type last, size_type count, size_type limit )
+            {
+                const size_type m = limit == 0 ? (count > 0 ? 1 : 0) : (count + limit - 1) / limit;
+                const bool back = last == this->size();
+
+                for ( size_type i = last + 1; i < starts.size(); i++ )
+                    starts[i] = starts[i] + count - (starts[last] - starts[first]);
+
+                // new blocks ends replace old ones
+                starts.erase(starts.begin() + first + 1, starts.begin() + last + 1);
+                starts.insert(starts.begin() + first + 1, m, starts[first]);
+
+                for ( size_type i = 0; i < m; i++ )
+                {
+                    const size_type size = limit == 0 ? count : back ? std::min(limit, count - i * limit) : count / m + (i < count % m ? 1 : 0);
+                    starts[first + i + 1] = starts[first + i] + size;
+                }
+
+                return first + m;
+            }
+
+            void swap( segment_blocks & rhs ) { starts.swap(rhs.starts); }
+
+            starts_type starts; ///< First segment of every block and number of segments
+        };
+    }
+
+    // ----------------------------------------------------------------
+    /// This exception will be thrown if spline invariant breaked
+    class spline_segments_disconnected_exception : public exception
+    {
+    public:
+        explicit spline_segments_disconnected_exception( const std::string & msg ) : exception(msg) {}
+    };
+
+    class spline_empty_exception : public exception
+    {
+    public:
+      explicit spline_empty_exception( const std::string & msg ) : exception(msg) {}
+    };
+
+    // ----------------------------------------------------------------
+    /// spline class template
+    ///      Contains N segments
+    ///      Performs interpolation in range [0, N]
+    ///      If parameter is out of range it's mapped by policy extrapolation strategy (truncated by default)
+    ///
+    /// Class invariant: s[i+1](1) == s[i](0);
+    /// If modifiers will try to break invariant then 'spline_segments_disconnected_exception' will be thrown
+    /// (unless policy verification strategy is verify_off)
+    ///
+    /// Alloc is used for segments storage, decorators and builders rebind it for their data (see allocator.h).
+    /// inline_storage<N, Alloc> keeps up to N segments (and control points of builders) inside the object (see small_vector.h)
+    template < typename S
+             , class SCVT = segments_connected_verification_traits<typename S::value_type>
+             , class Alloc = std::allocator<S>
+             >
+        class spline
+    {
+    public:
+        /// Apply metafunction provide the ability to obtain spline with other other segment type
+        /// It's required to use decorated segments in spline decorators
+        template < typename OtherS > struct apply
+        {
+            typedef spline<OtherS, SCVT, Alloc> type;
+        };
+
+    public:
+        static const size_type Degree = S::Degree;
+
+        //@{ common types definition
+        typedef SCVT segments_connected_verification_traits;
+        typedef typename details::spline_policy_of<SCVT>::type policy_type;
+        typedef S segment_type;
+
+        typedef typename segment_type::parameter_type parameter_type;
+        typedef typename segment_type::value_type value_type;
+
+        typedef typename details::storage_traits<Alloc, S>::allocator_type allocator_type;
+        typedef typename details::storage_traits<Alloc, S>::container_type storage_type;
+
+        typedef typename storage_type::const_iterator const_iterator;
+        typedef typename storage_type::const_reference const_reference;
+        //@}
+
+        /// Container of other elements with the same storage selector (e.g. builders control points)
+        template < typename T > struct container
+        {
+            typedef typename details::storage_traits<Alloc, T>::container_type type;
+        };
+
+        /// Container of cached data of decorators (shared by copies with shared_storage, see snapshot.h),
+        /// data is updated by blocks of up to 'block' segments, see details::segment_blocks
+        template < typename T > struct cache
+        {
+            typedef typename details::storage_traits<Alloc, T>::cache_type type;
+            static const size_type block = details::storage_traits<Alloc, T>::cache_block;
+        };
+
+    public:
+        /// Default constructor
+        spline () : m_Revision(0) {}
+
+        /// Constructor of empty spline with allocator
+        explicit spline ( const allocator_type & alloc ) : m_Segs(alloc), m_Revision(0) {}
+
+        /// Generic copy constructor
+        template < class OtherS >
+            spline ( const OtherS & rhs )
+                : m_Revision(0)
+        {
+            assign(rhs.begin(), rhs.end());
+        }
+
+        /// Generic assignment operator
+        template < class OtherS >
+            spline & operator= ( const OtherS & rhs )
+        {
+            return *this = spline(rhs); 
+        }
+
+#if defined(GSL_CXX11)
+        //@{ Copy and move operations, moved-from spline is empty
+        spline ( const spline & ) = default;
+        spline & operator= ( const spline & ) = default;
+
+        spline ( spline && rhs )
+            : m_Segs(std::move(rhs.m_Segs))
+            , m_Revision(rhs.m_Revision)
+            , m_Log(rhs.m_Log)
+        {
+            rhs.m_Segs.clear();
+            rhs.m_Revision = details::next_revision();
+            rhs.m_Log.clear();
+        }
+
+        spline & operator= ( spline && rhs )
+        {
+            if ( this == &rhs )
+                return *this;
+
+            m_Segs = std::move(rhs.m_Segs);
+            m_Revision = rhs.m_Revision;
+            m_Log = rhs.m_Log;
+            rhs.m_Segs.clear();
+            rhs.m_Revision = details::next_revision();
+            rhs.m_Log.clear();
+            return *this;
+        }
+        //@}
+#endif
+
+        /// Constructor by segments
+        template < typename InIt >
+            spline ( InIt first, InIt last, const allocator_type & alloc = allocator_type() );
+
+        /// Obtain interpolated value
+        value_type operator() ( parameter_type t ) const;
+
+        /// Obtain 'K' derivative value
+        template < size_type K >
+            value_type derivative ( parameter_type t ) const;
+
+        /// Obtain value and derivatives 1..K in a single pass
+        template < size_type K >
+            segment_jet<parameter_type, value_type, K> evaluate_jet ( parameter_type t ) const;
+
+        /// Obtain interpolated values for parameters [first, last)
+        /// Consecutive parameters of the same segment are evaluated together, so ordered input is preferable
+        template < class InIt, class OutIt >
+            OutIt evaluate ( InIt first, InIt last, OutIt out ) const;
+
+        /// Obtain 'K' derivative values for parameters [first, last)
+        template < size_type K, class InIt, class OutIt >
+            OutIt derivative ( InIt first, InIt last, OutIt out ) const;
+
+        /// Number of spline segments
+        size_type size () const { return m_Segs.size(); }
+
+        /// Check spline is empty
+        bool empty () const { return m_Segs.empty(); }
+        
+        /// Access to the segment with specified index
+        const_reference operator[] ( size_type idx ) const { return m_Segs[idx]; }
+
+        /// Checked access to the segment with specified index
+        const_reference at ( size_type idx ) const { return m_Segs.at(idx); }
+
+        /// Iterator which points to the first segment
+        const_iterator begin () const { return m_Segs.begin(); }
+
+        /// Iterator which points to the element after last
+        const_iterator end () const { return m_Segs.end(); }
+
+        /// Remove segments from 'from' to 'to' and insert segments [first, last) instead
+        template < class InIt >
+            void replace ( size_type from, size_type to, InIt first, InIt last );
+
+        /// Replace all existing segments with specified [first, last) segments
+        template < typename InIt >
+            void assign ( InIt first, InIt last );
+
+        /// Swap two splines
+        void swap ( spline & rhs ) { m_Segs.swap(rhs.m_Segs); std::swap(m_Revision, rhs.m_Revision); std::swap(m_Log, rhs.m_Log); }
+        
+        /// Clear spline
+        void clear () { m_Segs.clear(); m_Revision = details::next_revision(); m_Log.clear(); }
+
+        /// Revision of segments, every modifier takes a new value of the global counter, copies keep it,
+        /// so splines with equal revisions have equal segments. Decorators use it to invalidate cached data
+        size_type revision () const { return m_Revision; }
+
+        /// Obtain numbers of first and last segments which weren't replaced since specified revision.
+        /// Last replace calls are logged (assign and clear reset the log), so decorators update cached data
+        /// of replaced segments only. Return false if revision isn't logged
+        bool changed_since ( size_type revision, size_type * head, size_type * tail ) const { return m_Log.find(revision, head, tail); }
+
+        /// Allocator of segments
+        allocator_type get_allocator () const { return m_Segs.get_allocator(); }
+
+        /// Build cached data of decorators. Const methods are safe to call concurrently after that
+        /// until spline is modified
+        void prepare () const {}
+
+        /// Approximate spline with polyline (polylines of segments, see segment::approximate)
+        template < class OutPtIt >
+            OutPtIt approximate ( parameter_type accuracy, OutPtIt out ) const;
+
+        /// Approximate spline with polyline to the buffer, return number of polyline points.
+        /// If it's greater than capacity, only first 'capacity' points are written
+        size_type approximate ( parameter_type accuracy, value_type * buffer, size_type capacity ) const;
+
+        /// Approximate spline with polylines at uniform parameters of segments, see segment::approximate_predicted
+        template < class OutPtIt >
+            OutPtIt approximate_predicted ( parameter_type accuracy, OutPtIt out ) const;
+
+        /// Number of polyline points of approximate_predicted (output can be preallocated)
+        size_type predict_approximation ( parameter_type accuracy ) const;
+
+        /// Obtain n values per segment at uniform parameters by forward differencing and spline ending
+        /// (size() * n + 1 values, segments joints are not repeated), see segment::sample_uniform
+        template < class OutPtIt >
+            void sample_uniform ( size_type n, OutPtIt out, size_type reanchor = 0 ) const;
+
+        /// Obtain curvature
+        parameter_type curvature( parameter_type t ) const;
+
+        /// Obtain curvature radius
+        parameter_type radius( parameter_type t ) const;
+
+        /// Obtain torsion
+        parameter_type torsion( parameter_type t ) const;
+
+        /// Obtain torsion radius
+        parameter_type torsion_radius( parameter_type t ) const;
+
+        /// Obtain direction
+        value_type direction( parameter_type t ) const;
+
+        /// Obtain normal
+        value_type normal( parameter_type t ) const;
+
+        /// Obtain binormal
+        value_type binormal( parameter_type t ) const;
+
+    protected:
+        void verify() const;
+        void verify( size_type from, size_type to ) const;
+        size_type parameter2idx( parameter_type & t ) const GSL_NOEXCEPT_IF(!policy_type::checked);
+
+    private:
+        storage_type m_Segs;
+        size_type m_Revision;
+        details::change_log m_Log;
+    };
+
+    // ================================================================
+    // spline class template
+    // Implementation
+
+#define TE template < typename S, class SCVT, class Alloc >
+#define ME spline<S, SCVT, Alloc>::
+
+    // ----------------------------------------------------------------
+    TE typename S::value_type ME operator() ( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i](t);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < size_type Deg > typename S::value_type ME derivative ( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].template derivative<Deg>(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < size_type K > segment_jet<typename S::parameter_type, typename S::value_type, K> ME evaluate_jet ( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].template evaluate_jet<K>(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt, class OutIt > OutIt ME evaluate ( InIt first, InIt last, OutIt out ) const
+    {
+        return this->template derivative<0>(first, last, out);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < size_type K, class InIt, class OutIt > OutIt ME derivative ( InIt first, InIt last, OutIt out ) const
+    {
+        const size_type BlockSize = 256;
+
+        parameter_type ts[BlockSize];
+        size_type idx[BlockSize];
+        value_type vals[BlockSize];
+
+        while ( first != last )
+        {
+            size_type n = 0;
+            for ( ; n < BlockSize && first != last; ++n, ++first )
+            {
+                ts[n] = *first;
+                idx[n] = this->parameter2idx(ts[n]);
+            }
+
+            for ( size_type b = 0, e = 0; b < n; b = e )
+            {
+                for ( e = b + 1; e < n && idx[e] == idx[b]; e++ ) {}
+                m_Segs[idx[b]].template derivative<K>(ts + b, ts + e, vals + b);
+            }
+
+            out = std::copy(vals, vals + n, out);
+        }
+
+        return out;
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt > ME spline ( InIt first, InIt last, const allocator_type & alloc )
+        : m_Segs(first, last, alloc)
+        , m_Revision(details::next_revision())
+    {
+        this->verify();
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt > void ME replace ( size_type from, size_type to, InIt first, InIt last )
+    {
+        const size_type old_size = m_Segs.size();
+
+        // overwrite segments in place, then erase or insert the rest
+        typename storage_type::iterator it = m_Segs.begin() + from, end = m_Segs.begin() + to;
+        for ( ; it != end && first != last; ++it, ++first )
+            *it = *first;
+
+        it = m_Segs.erase(it, end);
+        m_Segs.insert(it, first, last);
+        m_Log.push(m_Revision, from, old_size - to);
+        m_Revision = details::next_revision();
+
+        // only joints of inserted segments with each other and with neighbours could be broken
+        const size_type inserted = m_Segs.size() + (to - from) - old_size;
+        this->verify(from > 0 ? from - 1 : 0, from + inserted);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt > void ME assign ( InIt first, InIt last )
+    {
+        spline tmp(first, last, this->get_allocator());
+        tmp.swap(*this);
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class OutPtIt > OutPtIt ME approximate ( parameter_type accuracy, OutPtIt out ) const
+    {
+      for ( size_type i = 0; i < m_Segs.size(); i++ )
+        out = m_Segs[i].approximate(accuracy, out);
+
+      return out;
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME approximate ( parameter_type accuracy, value_type * buffer, size_type capacity ) const
+    {
+        return this->approximate(accuracy, details::bounded_output_iterator<value_type>(buffer, capacity)).count();
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class OutPtIt > OutPtIt ME approximate_predicted ( parameter_type accuracy, OutPtIt out ) const
+    {
+        for ( size_type i = 0; i < m_Segs.size(); i++ )
+            out = m_Segs[i].approximate_predicted(accuracy, out);
+
+        return out;
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME predict_approximation ( parameter_type accuracy ) const
+    {
+        size_type count = 0;
+        for ( size_type i = 0; i < m_Segs.size(); i++ )
+            count += m_Segs[i].predict_approximation(accuracy);
+
+        return count;
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class OutPtIt > void ME sample_uniform ( size_type n, OutPtIt out, size_type reanchor ) const
+    {
+        if ( m_Segs.empty() )
+            return;
+
+        n = std::max(size_type(1), n);
+
+        for ( size_type i = 0; i < m_Segs.size(); i++ )
+            out = details::sample_uniform(m_Segs[i], n, n, reanchor, out);
+
+        *out++ = m_Segs.back().ending();
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::parameter_type ME curvature( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].curvature(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::parameter_type ME radius( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].radius(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::parameter_type ME torsion( parameter_type t ) const
+    {
+        if ( m_Segs.empty() )
+            return parameter_type(); // TODO: throw exception ?
+
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].torsion(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::parameter_type ME torsion_radius( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].torsion_radius(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::value_type ME direction( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].direction(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::value_type ME normal( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].normal(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE typename S::value_type ME binormal( parameter_type t ) const
+    {
+        size_type i = this->parameter2idx(t);
+        return m_Segs[i].binormal(t);
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME verify() const
+    {
+        this->verify(0, m_Segs.size());
+    }
+
+    // ----------------------------------------------------------------
+    /// Verify joints of segments [from, to) with following ones (all joints or none depending on policy)
+    TE void ME verify( size_type from, size_type to ) const
+    {
+        if ( policy_type::verification == verify_off )
+            return;
+
+        if ( policy_type::verification == verify_full )
+        {
+            from = 0;
+            to = m_Segs.size();
+        }
+
+        for ( size_type i = from; i < to && i + 1 < m_Segs.size(); i++ )
+            if ( !policy_type::eq(m_Segs[i](1), m_Segs[i + 1](0)) )
+                throw spline_segments_disconnected_exception("");
+    }
+
+    // ----------------------------------------------------------------
+    TE size_type ME parameter2idx( parameter_type & t ) const GSL_NOEXCEPT_IF(!policy_type::checked)
+    {
+        if ( policy_type::checked && m_Segs.empty() )
+            throw spline_empty_exception("");
+
+        const size_type n = m_Segs.size();
+
+        if ( policy_type::extrapolation == extrapolation_cycle && (t < 0 || t >= n) )
+            t -= n * std::floor(t / n);
+
+        if ( t <= 0 )
+        {
+            if ( policy_type::extrapolation != extrapolation_extrapolate )
+                t = 0;
+            return 0;
+        }
+
+        if ( t >= n )
+        {
+            // cycled parameter could be rounded to n
+            if ( policy_type::extrapolation == extrapolation_extrapolate )
+                t -= n - 1;
+            else if ( policy_type::extrapolation == extrapolation_cycle )
+                t = 0;
+            else
+                t = 1;
+
+            return policy_type::extrapolation == extrapolation_cycle ? 0 : n - 1;
+        }
+
+        size_type i = size_type(t);
+        t -= i;
+
+        return i;
+    }
+
+#undef TE
+#undef ME
+
+}
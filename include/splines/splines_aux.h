@@ -1,129 +1,386 @@
-///////////////////////////////////////////////////////////////////////////////
-/// common definitions and auxiliary stuff
-
-#pragma once
-
-#include <stdexcept>
-
-namespace gsl
-{
-    typedef size_t size_type;
-
-    // ----------------------------------------------------------------
-    /// gsl exceptions base class
-    class exception : public std::runtime_error
-    {
-    public:
-        explicit exception( const std::string & msg ) : std::runtime_error(msg) {}
-    };
-
-    // ----------------------------------------------------------------
-    /// Derived segment decorators should use this macros to provide constructing ability
-#define GSL_SEGMENT_DECORATOR(decorator)        \
-    decorator () {}                     \
-    template < class Seg > decorator( const Seg & rhs ) : Base(rhs) {}                                  \
-    template < class Seg > decorator& operator= ( const Seg & rhs ) { return *this = decorator(rhs); }  \
-    template < typename InIt > decorator ( InIt first, InIt last ) : Base(first, last) {}               \
-    typedef typename Base::parameter_type parameter_type;                                               \
-    typedef typename Base::value_type value_type;
-
-    // ----------------------------------------------------------------
-    /// Derived spline decorators should use this macros to provide constructing ability
-#define GSL_SPLINE_DECORATOR(decorator)     \
-    decorator () {}                         \
-    template < typename InIt > decorator( InIt first, InIt last ) : Base::template apply<S>::type(first, last) {} \
-    template < typename OtherS > struct apply { typedef spline_arclength<Base, OtherS> type; };                 \
-    template < class OtherS > decorator( const OtherS & rhs ) : Base::template apply<S>::type(rhs.begin(), rhs.end()) {} \
-    template < class OtherS > decorator& operator= ( const OtherS & rhs ) { return *this = decorator(rhs); }    \
-    typedef S segment_type;                                                                                     \
-    typedef typename segment_type::parameter_type parameter_type;                                               \
-    typedef typename segment_type::value_type value_type;
-
-    // ----------------------------------------------------------------
-    namespace details
-    {
-        inline size_type d_coef( size_type n, size_type k )
-        {
-            if ( k > n ) return 0;
-            if ( k == 0 ) return 1;
-
-            size_t ret = n;
-
-            while ( --k )
-                ret *= --n;
-
-            return ret;
-        }
-
-        template < class T > T fac( size_type n )
-        {
-            T res = 1;
-            for ( size_type i = 2; i <= n; i++ )
-                res *= i;
-
-            return res;
-        }
-
-        template < class T, class Fn > T golden_section( T a, T b, T accuracy, Fn f )
-        {
-            T s1 = (3 - sqrt(5.)) / 2;
-            T s2 = (sqrt(5.) - 1) / 2;
-            T u1 = a + s1 * (b - a);
-            T u2 = a + s2 * (b - a);
-            T fu1 = f(u1);
-            T fu2 = f(u2);
-
-            while ( fabs(a - b) > accuracy )
-            {
-                if ( fu1 <= fu2 )
-                {
-                    b   = u2;
-                    u2  = u1;
-                    fu2 = fu1;
-                    u1  = a + s1 * (b - a);
-                    fu1 = f(u1);
-                }
-                else
-                {
-                    a   = u1;
-                    u1  = u2;
-                    fu1 = fu2;
-                    u2  = a + s2 * (b - a);
-                    fu2 = f(u2);
-                }
-            }
-
-            return (fu1 < fu2) ? a : b;
-        }
-
-        // @todo refactor this
-        inline double norm_( double p )
-        {
-            return p;
-        }
-
-        inline bool eq_zero( double x )
-        {
-            return x < 1e-8;
-        }
-
-        // @todo move to value_type_traits ???
-        template < class value_type >
-        inline double norm_( const value_type & p )
-        {
-            return norm(p);
-        }
-
-        template < class value_type >
-        inline value_type perp_( const value_type & dir )
-        {
-           return perp(dir);
-        }
-
-        template < class value_type >
-        inline value_type normalized_( const value_type & p )
-        {
-            return normalized(p);
-        }
-    }
-}
+///////////////////////////////////////////////////////////////////////////////
+/// common definitions and auxiliary stuff
+
+#pragma once
+
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+namespace gsl
+{
+    typedef size_t size_type;
+
+    // ----------------------------------------------------------------
+    /// gsl exceptions base class
+    class exception : public std::runtime_error
+    {
+    public:
+        explicit exception( const std::string & msg ) : std::runtime_error(msg) {}
+    };
+
+    // ----------------------------------------------------------------
+    /// C++11 features are used if compiler supports them, library itself requires C++03 only
+#if !defined(GSL_CXX11) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+#   define GSL_CXX11
+#endif
+
+    /// Conditional noexcept specification (C++11), nothing for C++03 compilers
+#if defined(GSL_CXX11)
+#   define GSL_NOEXCEPT_IF(cond) noexcept(cond)
+#else
+#   define GSL_NOEXCEPT_IF(cond)
+#endif
+
+    /// Defaulted copy and move operations (C++11), implicit copy operations are used by C++03 compilers
+#if defined(GSL_CXX11)
+#   define GSL_DEFAULT_COPY_MOVE(type)                  \
+    type( const type & ) = default;                     \
+    type( type && ) = default;                          \
+    type & operator= ( const type & ) = default;        \
+    type & operator= ( type && ) = default;
+#else
+#   define GSL_DEFAULT_COPY_MOVE(type)
+#endif
+
+    // ----------------------------------------------------------------
+    /// Derived segment decorators should use this macros to provide constructing ability
+#define GSL_SEGMENT_DECORATOR(decorator)        \
+    decorator () {}                     \
+    template < class Seg > decorator( const Seg & rhs ) : Base(rhs) {}                                  \
+    template < class Seg > decorator& operator= ( const Seg & rhs ) { return *this = decorator(rhs); }  \
+    template < typename InIt > decorator ( InIt first, InIt last ) : Base(first, last) {}               \
+    typedef typename Base::parameter_type parameter_type;                                               \
+    typedef typename Base::value_type value_type;
+
+    // ----------------------------------------------------------------
+    /// Derived spline decorators should use this macros to provide constructing ability
+#define GSL_SPLINE_DECORATOR(decorator)     \
+    typedef typename Base::template apply<S>::type::allocator_type allocator_type;                              \
+    decorator () {}                         \
+    explicit decorator( const allocator_type & alloc ) : Base::template apply<S>::type(alloc) {}               \
+    template < typename InIt > decorator( InIt first, InIt last ) : Base::template apply<S>::type(first, last) {} \
+    template < typename InIt > decorator( InIt first, InIt last, const allocator_type & alloc )                 \
+        : Base::template apply<S>::type(first, last, alloc) {}                                                  \
+    GSL_DEFAULT_COPY_MOVE(decorator)                                                                            \
+    template < typename OtherS > struct apply { typedef decorator<Base, OtherS> type; };                        \
+    template < class OtherS > decorator( const OtherS & rhs ) : Base::template apply<S>::type(rhs.begin(), rhs.end()) {} \
+    template < class OtherS > decorator& operator= ( const OtherS & rhs ) { return *this = decorator(rhs); }    \
+    typedef S segment_type;                                                                                     \
+    typedef typename segment_type::parameter_type parameter_type;                                               \
+    typedef typename segment_type::value_type value_type;
+
+    // ----------------------------------------------------------------
+    namespace details
+    {
+        template < typename A, typename B > struct is_same { static const bool value = false; };
+        template < typename A > struct is_same<A, A> { static const bool value = true; };
+
+        /// Compile-time bool for overload based dispatch
+        template < bool B > struct bool_constant { static const bool value = B; };
+
+        inline size_type d_coef( size_type n, size_type k )
+        {
+            if ( k > n ) return 0;
+            if ( k == 0 ) return 1;
+
+            size_t ret = n;
+
+            while ( --k )
+                ret *= --n;
+
+            return ret;
+        }
+
+        /// Replace elements [from, to) of vector with 'count' value initialized elements, elements after
+        /// them are shifted (decorators update cached data of replaced segments, see spline::changed_since)
+        template < class V >
+            void splice( V & v, size_type from, size_type to, size_type count )
+        {
+            if ( count < to - from )
+                v.erase(v.begin() + from + count, v.begin() + to);
+            else
+                v.insert(v.begin() + to, from + count - to, typename V::value_type());
+        }
+
+        template < class T > T fac( size_type n )
+        {
+            T res = 1;
+            for ( size_type i = 2; i <= n; i++ )
+                res *= i;
+
+            return res;
+        }
+
+        template < class T, class Fn > T golden_section( T a, T b, T accuracy, Fn f )
+        {
+            T s1 = (3 - sqrt(5.)) / 2;
+            T s2 = (sqrt(5.) - 1) / 2;
+            T u1 = a + s1 * (b - a);
+            T u2 = a + s2 * (b - a);
+            T fu1 = f(u1);
+            T fu2 = f(u2);
+
+            while ( fabs(a - b) > accuracy )
+            {
+                if ( fu1 <= fu2 )
+                {
+                    b   = u2;
+                    u2  = u1;
+                    fu2 = fu1;
+                    u1  = a + s1 * (b - a);
+                    fu1 = f(u1);
+                }
+                else
+                {
+                    a   = u1;
+                    u1  = u2;
+                    fu1 = fu2;
+                    u2  = a + s2 * (b - a);
+                    fu2 = f(u2);
+                }
+            }
+
+            return (fu1 < fu2) ? a : b;
+        }
+
+        /// Evaluate polynomial c[0] + c[1]*t + ... + c[n-1]*t^(n-1)
+        template < class T > T horner( const T * c, size_type n, T t )
+        {
+            T r = c[n - 1];
+            for ( size_type i = n - 1; i > 0; i-- )
+                r = r * t + c[i - 1];
+
+            return r;
+        }
+
+        // ----------------------------------------------------------------
+        /// Real roots in [0, 1] of polynomial c[0] + c[1]*t + ... + c[N-1]*t^(N-1)
+        ///     Roots of derivative split [0, 1] into monotonic intervals, root of every interval
+        ///     with sign change is found by Newton method safeguarded by bisection.
+        ///     Roots are sorted, return number of roots
+        template < typename T, size_type N >
+            struct polynomial_roots
+        {
+            static size_type apply( const T * c, T * roots )
+            {
+                T dc[N - 1];
+                for ( size_type i = 1; i < N; i++ )
+                    dc[i - 1] = i * c[i];
+
+                T ends[N + 1];
+                const size_type n = polynomial_roots<T, N - 1>::apply(dc, ends + 1);
+                ends[0] = 0;
+                ends[n + 1] = 1;
+
+                size_type count = 0;
+                T a = 0, fa = horner(c, N, a);
+                for ( size_type i = 1; i <= n + 1; i++ )
+                {
+                    const T b = ends[i], fb = horner(c, N, b);
+
+                    if ( fa == 0 )
+                    {
+                        if ( count == 0 || roots[count - 1] != a )
+                            roots[count++] = a;
+                    }
+                    else if ( fb != 0 && (fa < 0) != (fb < 0) )
+                        roots[count++] = refine(c, dc, a, b, fa);
+
+                    a = b;
+                    fa = fb;
+                }
+
+                if ( fa == 0 && (count == 0 || roots[count - 1] != a) )
+                    roots[count++] = a;
+
+                return count;
+            }
+
+            /// Root of polynomial c in [a, b], c is monotonic in [a, b] and changes sign, dc is derivative of c
+            static T refine( const T * c, const T * dc, T a, T b, T fa )
+            {
+                const T eps = 4 * std::numeric_limits<T>::epsilon();
+
+                // polynomial value can't be computed more precisely in [0, 1]
+                T noise = 0;
+                for ( size_type i = 0; i < N; i++ )
+                    noise += fabs(c[i]);
+                noise *= 2 * N * std::numeric_limits<T>::epsilon();
+
+                // start from secant point
+                T x = a + (b - a) * fa / (fa - horner(c, N, b));
+                if ( !(a < x && x < b) )
+                    x = (a + b) / 2;
+
+                for ( size_type k = 0; k < 100; k++ )
+                {
+                    const T fx = horner(c, N, x);
+                    if ( fabs(fx) <= noise )
+                        break;
+
+                    if ( (fx < 0) == (fa < 0) )
+                    {
+                        a = x;
+                        fa = fx;
+                    }
+                    else
+                        b = x;
+
+                    const T dfx = horner(dc, N - 1, x);
+                    T nx = (dfx != 0) ? x - fx / dfx : a;
+                    if ( !(a < nx && nx < b) )
+                        nx = (a + b) / 2;
+
+                    if ( fabs(nx - x) <= eps || b - a <= eps )
+                        return nx;
+
+                    x = nx;
+                }
+
+                return x;
+            }
+        };
+
+        template < typename T >
+            struct polynomial_roots<T, 1>
+        {
+            static size_type apply( const T *, T * ) { return 0; }
+        };
+
+        template < typename T >
+            struct polynomial_roots<T, 2>
+        {
+            static size_type apply( const T * c, T * roots )
+            {
+                if ( c[1] == 0 )
+                    return 0;
+
+                const T x = -c[0] / c[1];
+                if ( x < 0 || x > 1 )
+                    return 0;
+
+                roots[0] = x;
+                return 1;
+            }
+        };
+
+        template < typename T >
+            struct polynomial_roots<T, 3>
+        {
+            static size_type apply( const T * c, T * roots )
+            {
+                if ( c[2] == 0 )
+                    return polynomial_roots<T, 2>::apply(c, roots);
+
+                const T D = c[1] * c[1] - 4 * c[2] * c[0];
+                if ( D < 0 )
+                    return 0;
+
+                // numerically stable form of quadratic roots
+                const T q = -(c[1] + (c[1] < 0 ? -sqrt(D) : sqrt(D))) / 2;
+                T x[2] = { q / c[2], q != 0 ? c[0] / q : q / c[2] };
+                if ( x[0] > x[1] )
+                    std::swap(x[0], x[1]);
+
+                size_type count = 0;
+                for ( size_type i = 0; i < 2; i++ )
+                    if ( 0 <= x[i] && x[i] <= 1 && (count == 0 || roots[count - 1] != x[i]) )
+                        roots[count++] = x[i];
+
+                return count;
+            }
+        };
+
+        // @todo refactor this
+        inline double norm_( double p )
+        {
+            return p;
+        }
+
+        inline bool eq_zero( double x )
+        {
+            return x < 1e-8;
+        }
+
+        // @todo move to value_type_traits ???
+        template < class value_type >
+        inline double norm_( const value_type & p )
+        {
+            return norm(p);
+        }
+
+        template < class value_type >
+        inline value_type perp_( const value_type & dir )
+        {
+           return perp(dir);
+        }
+
+        template < class value_type >
+        inline value_type normalized_( const value_type & p )
+        {
+            return normalized(p);
+        }
+
+        /// Distance from point p to line segment [a, b]. Only norms of differences are used: height of
+        /// triangle is obtained by Heron formula in numerically stable form (sides are sorted), so thin
+        /// triangles are handled
+        template < class value_type >
+        inline double chord_distance_( const value_type & p, const value_type & a, const value_type & b )
+        {
+            double x = norm_(p - a), y = norm_(p - b);
+            const double c = norm_(b - a);
+
+            // projection of p is out of segment
+            if ( c == 0 || x * x >= y * y + c * c || y * y >= x * x + c * c )
+                return std::min(x, y);
+
+            double z = c;
+            if ( x < y ) std::swap(x, y);
+            if ( y < z ) std::swap(y, z);
+            if ( x < y ) std::swap(x, y);
+
+            const double area4 = (x + (y + z)) * std::max(0.0, z - (x - y)) * (z + (x - y)) * (x + (y - z));
+            return sqrt(area4) / (2 * c);
+        }
+
+        // ----------------------------------------------------------------
+        /// Output iterator which writes values to the buffer while it has free space and counts
+        /// all written values
+        template < typename U >
+            class bounded_output_iterator
+        {
+        public:
+            typedef std::output_iterator_tag iterator_category;
+            typedef void value_type;
+            typedef void difference_type;
+            typedef void pointer;
+            typedef void reference;
+
+            bounded_output_iterator( U * buffer, size_type capacity ) : m_Buffer(buffer), m_Capacity(capacity), m_Count(0) {}
+
+            bounded_output_iterator & operator* () { return *this; }
+            bounded_output_iterator & operator++ () { return *this; }
+            bounded_output_iterator & operator++ ( int ) { return *this; }
+
+            bounded_output_iterator & operator= ( const U & val )
+            {
+                if ( m_Count < m_Capacity )
+                    m_Buffer[m_Count] = val;
+
+                m_Count++;
+                return *this;
+            }
+
+            /// Number of written values, including ones which didn't fit to the buffer
+            size_type count() const { return m_Count; }
+
+        private:
+            U * m_Buffer;
+            size_type m_Capacity;
+            size_type m_Count;
+        };
+    }
+}
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Streaming spline builder
+/// Control points are appended one by one (e.g. from sensors feed), segment is appended
+/// to the spline as soon as all control points it depends on are known.
+/// Only control points required for next segments are stored.
+///
+/// Segments at the end of stream which use clamped control values (e.g. catmull_rom_spline
+/// last segment) are provisional: they are appended by flush() and rebuilt by next push_back().
+///
+/// If maximum segments count is specified old segments are evicted from the front of the spline,
+/// so spline parameter 0 corresponds to the global segment evicted().
+/// Spline keeps [max_segments, 2 * max_segments) finalized segments, front segments are evicted in chunks.
+
+#pragma once
+
+#include "builder.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// stream_builder class template
+    ///     BuildPolicy is the same as for spline_builder (catmull_rom_spline, b_spline, bezier_spline, bezier_n_spline)
+    template < class Base, template <class> class BuildPolicy >
+        class stream_builder
+            : public Base
+            , public BuildPolicy<Base>
+    {
+    public:
+        //@{ Common types definition
+        typedef typename Base::segment_type segment_type;
+        typedef typename Base::parameter_type parameter_type;
+        typedef typename Base::value_type value_type;
+        typedef typename Base::allocator_type allocator_type;
+
+        typedef std::vector<value_type, typename details::rebind_alloc<allocator_type, value_type>::type> window_type;
+        //@}
+
+    public:
+        /// Constructor. Zero max_segments means that segments are never evicted
+        explicit stream_builder( size_type max_segments = 0, const allocator_type & alloc = allocator_type() );
+
+#if defined(GSL_CXX11)
+        //@{ Copy and move operations, moved-from builder is cleared (see clear), max segments count is kept
+        stream_builder( const stream_builder & ) = default;
+        stream_builder & operator= ( const stream_builder & ) = default;
+
+        stream_builder( stream_builder && rhs );
+        stream_builder & operator= ( stream_builder && rhs );
+        //@}
+#endif
+
+        /// Append control point
+        void push_back( const value_type & val );
+
+        /// Append control points [first, last)
+        template < class InIt >
+            void append( InIt first, InIt last );
+
+        /// Append provisional segments built on the known control points
+        void flush();
+
+        /// Remove all segments and control points
+        void clear();
+
+        /// Number of appended control points
+        size_type points_count() const { return m_Offset + m_Window.size(); }
+
+        /// Number of segments evicted from the front of the spline
+        size_type evicted() const { return m_Evicted; }
+
+        /// Number of provisional segments at the end of the spline
+        size_type provisional() const { return m_Provisional; }
+
+        /// Stored control points, window()[0] is the control point with index window_offset()
+        const window_type & window() const { return m_Window; }
+        size_type window_offset() const { return m_Offset; }
+
+    private:
+        typedef BuildPolicy<Base> build_policy;
+
+        void erase_segments( size_type from, size_type to );
+
+    private:
+        window_type m_Window;
+        std::vector<segment_type, allocator_type> m_Tail;
+        size_type m_Offset;
+        size_type m_Built;
+        size_type m_Evicted;
+        size_type m_Provisional;
+        size_type m_MaxSegments;
+    };
+
+    // ================================================================
+    // stream_builder class template
+    // Implementation
+
+#define TE template < class Base, template <class> class BuildPolicy >
+#define ME stream_builder<Base, BuildPolicy>::
+
+    // ----------------------------------------------------------------
+    TE ME stream_builder( size_type max_segments, const allocator_type & alloc )
+        : Base(alloc)
+        , m_Window(alloc)
+        , m_Tail(alloc)
+        , m_Offset(0)
+        , m_Built(0)
+        , m_Evicted(0)
+        , m_Provisional(0)
+        , m_MaxSegments(max_segments)
+    {
+    }
+
+#if defined(GSL_CXX11)
+    // ----------------------------------------------------------------
+    TE ME stream_builder( stream_builder && rhs )
+        : Base(std::move(rhs))
+        , build_policy(std::move(rhs))
+        , m_Window(std::move(rhs.m_Window))
+        , m_Tail(std::move(rhs.m_Tail))
+        , m_Offset(rhs.m_Offset)
+        , m_Built(rhs.m_Built)
+        , m_Evicted(rhs.m_Evicted)
+        , m_Provisional(rhs.m_Provisional)
+        , m_MaxSegments(rhs.m_MaxSegments)
+    {
+        rhs.clear();
+    }
+
+    // ----------------------------------------------------------------
+    TE stream_builder<Base, BuildPolicy> & ME operator= ( stream_builder && rhs )
+    {
+        if ( this == &rhs )
+            return *this;
+
+        Base::operator=(std::move(rhs));
+        build_policy::operator=(std::move(rhs));
+        m_Window = std::move(rhs.m_Window);
+        m_Tail = std::move(rhs.m_Tail);
+        m_Offset = rhs.m_Offset;
+        m_Built = rhs.m_Built;
+        m_Evicted = rhs.m_Evicted;
+        m_Provisional = rhs.m_Provisional;
+        m_MaxSegments = rhs.m_MaxSegments;
+
+        rhs.clear();
+        return *this;
+    }
+#endif
+
+    // ----------------------------------------------------------------
+    TE void ME push_back( const value_type & val )
+    {
+        const size_type step = build_policy::segment_step;
+        const size_type behind = build_policy::look_behind;
+        const size_type ahead = build_policy::look_ahead;
+
+        if ( m_Provisional )
+        {
+            this->erase_segments(this->size() - m_Provisional, this->size());
+            m_Provisional = 0;
+        }
+
+        m_Window.push_back(val);
+
+        // segment is finalized when its last control point is known
+        while ( m_Built * step + ahead < this->points_count() )
+        {
+            const size_type i = m_Built * step - m_Offset;
+
+            segment_type seg;
+            this->build(m_Window, i, i + step + 1, &seg);
+            this->replace(this->size(), this->size(), &seg, &seg + 1);
+            ++m_Built;
+        }
+
+        // drop control points which aren't required for next segments,
+        // window is compacted when at least half of it is unused
+        const size_type needed = m_Built * step > behind ? m_Built * step - behind : 0;
+        const size_type unused = needed - m_Offset;
+        if ( unused > 0 && 2 * unused >= m_Window.size() )
+        {
+            m_Window.erase(m_Window.begin(), m_Window.begin() + unused);
+            m_Offset += unused;
+        }
+
+        if ( m_MaxSegments && this->size() >= 2 * m_MaxSegments )
+        {
+            const size_type count = this->size() - m_MaxSegments;
+            this->erase_segments(0, count);
+            m_Evicted += count;
+        }
+    }
+
+    // ----------------------------------------------------------------
+    TE template < class InIt > void ME append( InIt first, InIt last )
+    {
+        for ( ; first != last; ++first )
+            this->push_back(*first);
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME flush()
+    {
+        if ( m_Provisional || m_Window.empty() )
+            return;
+
+        m_Tail.clear();
+        this->build(m_Window, m_Built * build_policy::segment_step - m_Offset, m_Window.size(), back_inserter(m_Tail));
+        this->replace(this->size(), this->size(), m_Tail.begin(), m_Tail.end());
+        m_Provisional = m_Tail.size();
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME clear()
+    {
+        Base::clear();
+        m_Window.clear();
+        m_Offset = m_Built = m_Evicted = m_Provisional = 0;
+    }
+
+    // ----------------------------------------------------------------
+    TE void ME erase_segments( size_type from, size_type to )
+    {
+        m_Tail.clear();
+        this->replace(from, to, m_Tail.begin(), m_Tail.end());
+    }
+
+#undef TE
+#undef ME
+
+}
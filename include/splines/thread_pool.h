@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Simple thread pool for batch requests (requires C++11)
+/// Splines don't depend on this header: batch methods accept any Pool type which provides
+///     parallel_for(count, grain, fn) - call fn(from, to) for chunks of [0, count) and wait for completion
+///
+/// Call prepare() of spline before const methods are called concurrently (batch methods do it themselves).
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+
+#include "splines_aux.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// thread_pool class
+    ///      Calling thread takes part in parallel_for, so pool with N threads runs N + 1 chunks at once
+    class thread_pool
+    {
+    public:
+        /// Constructor. Zero threads count means hardware concurrency - 1
+        explicit thread_pool( size_type threads = 0 );
+
+        /// Destructor waits for running tasks
+        ~thread_pool();
+
+        /// Number of pool threads
+        size_type size() const { return m_Threads.size(); }
+
+        /// Call fn(from, to) for chunks of [0, count) with 'grain' items, return when all chunks are processed
+        /// First exception thrown by fn is rethrown
+        template < class Fn >
+            void parallel_for( size_type count, size_type grain, Fn fn );
+
+    private:
+        thread_pool( const thread_pool & );
+        thread_pool & operator= ( const thread_pool & );
+
+        void worker();
+
+    private:
+        std::vector<std::thread> m_Threads;
+        std::deque< std::function<void()> > m_Tasks;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Stop;
+    };
+
+    // ================================================================
+    // thread_pool class
+    // Implementation
+
+    // ----------------------------------------------------------------
+    inline thread_pool::thread_pool( size_type threads )
+        : m_Stop(false)
+    {
+        if ( threads == 0 )
+            threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+        for ( size_type i = 0; i < threads; i++ )
+            m_Threads.push_back(std::thread(&thread_pool::worker, this));
+    }
+
+    // ----------------------------------------------------------------
+    inline thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+
+        m_Condition.notify_all();
+
+        for ( size_type i = 0; i < m_Threads.size(); i++ )
+            m_Threads[i].join();
+    }
+
+    // ----------------------------------------------------------------
+    inline void thread_pool::worker()
+    {
+        for ( ;; )
+        {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_Stop || !m_Tasks.empty(); });
+
+                if ( m_Tasks.empty() )
+                    return;
+
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    // ----------------------------------------------------------------
+    template < class Fn > void thread_pool::parallel_for( size_type count, size_type grain, Fn fn )
+    {
+        grain = std::max(size_type(1), grain);
+        const size_type chunks = (count + grain - 1) / grain;
+
+        if ( chunks == 0 )
+            return;
+
+        if ( chunks == 1 || m_Threads.empty() )
+        {
+            fn(0, count);
+            return;
+        }
+
+        // chunks are taken by workers from shared counter, state outlives parallel_for
+        // if worker starts after all chunks are processed
+        struct state
+        {
+            std::atomic<size_type> next;
+            size_type done;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+
+        std::shared_ptr<state> st = std::make_shared<state>();
+        st->next = 0;
+        st->done = 0;
+
+        std::function<void()> run = [st, &fn, count, grain, chunks]
+        {
+            for ( ;; )
+            {
+                const size_type c = st->next++;
+                if ( c >= chunks )
+                    return;
+
+                try
+                {
+                    fn(c * grain, std::min(count, (c + 1) * grain));
+                }
+                catch ( ... )
+                {
+                    std::lock_guard<std::mutex> lock(st->mutex);
+                    if ( !st->error )
+                        st->error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(st->mutex);
+                if ( ++st->done == chunks )
+                    st->finished.notify_all();
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for ( size_type i = 0, n = std::min(m_Threads.size(), chunks - 1); i < n; i++ )
+                m_Tasks.push_back(run);
+        }
+
+        m_Condition.notify_all();
+
+        run();
+
+        std::unique_lock<std::mutex> lock(st->mutex);
+        st->finished.wait(lock, [&st, chunks] { return st->done == chunks; });
+
+        if ( st->error )
+            std::rethrow_exception(st->error);
+    }
+}
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+/// value_traits class template definition
+/// Describes value_type of segment as a vector of scalar components.
+/// Algorithms that work component-wise (vectorized evaluation, bounding boxes, ...)
+/// require specialization for user value_type, other algorithms use only value_type operators.
+///
+/// Specialization should provide:
+///     scalar_type - type of component
+///     dimension   - number of components
+///     packed      - value_type is layout compatible with scalar_type[dimension]
+///     get(v, i)   - obtain component 'i' of 'v'
+///     set(v, i, x) - assign component 'i' of 'v'
+/// Specializations should be declared with value_type (as math/point2.h and math/point3.h do),
+/// so they're visible wherever segments of value_type are instantiated.
+
+#pragma once
+
+#include "splines_aux.h"
+
+namespace gsl
+{
+    // ----------------------------------------------------------------
+    /// value_traits class template, value_type is opaque by default
+    template < typename U >
+        struct value_traits
+    {
+        static const size_type dimension = 0; ///< 0 - components are unknown
+    };
+
+    // ----------------------------------------------------------------
+    template <>
+        struct value_traits<double>
+    {
+        typedef double scalar_type;
+        static const size_type dimension = 1;
+        static const bool packed = true;
+
+        static scalar_type get( const double & v, size_type ) { return v; }
+        static void set( double & v, size_type, scalar_type x ) { v = x; }
+    };
+
+    // ----------------------------------------------------------------
+    template <>
+        struct value_traits<float>
+    {
+        typedef float scalar_type;
+        static const size_type dimension = 1;
+        static const bool packed = true;
+
+        static scalar_type get( const float & v, size_type ) { return v; }
+        static void set( float & v, size_type, scalar_type x ) { v = x; }
+    };
+
+    namespace details
+    {
+        /// Scalar type of value_type components (void for opaque value_type)
+        template < typename U, bool Opaque = (value_traits<U>::dimension == 0) >
+            struct scalar_of { typedef void type; };
+
+        template < typename U >
+            struct scalar_of<U, false> { typedef typename value_traits<U>::scalar_type type; };
+    }
+}